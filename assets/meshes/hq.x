@@ -16,6 +16,10 @@ template SkinWeights {
   Matrix4x4 matrixOffset;
 }
 
+AnimTicksPerSecond {
+  1000;
+}
+
 Frame Root {
   FrameTransformMatrix {
      1.000000, 0.000000, 0.000000, 0.000000,
@@ -9277,3 +9281,45 @@ Frame Root {
     } // End of HQ
   } // End of Armature
 } // End of Root
+AnimationSet Scan {
+  Animation {
+    {Armature_BigRadar}
+    AnimationKey { // Rotation
+      0;
+      5;
+      0;4; 1.000000, 0.000000, 0.000000, 0.000000;;,
+      1571;4; 0.707107, 0.000000,-0.707107, 0.000000;;,
+      3142;4; 0.000000, 0.000000,-1.000000, 0.000000;;,
+      4712;4;-0.707107, 0.000000,-0.707107, 0.000000;;,
+      6283;4;-1.000000, 0.000000, 0.000000, 0.000000;;;
+    }
+  }
+  Animation {
+    {Armature_SmallRadar}
+    AnimationKey { // Rotation
+      0;
+      21;
+      0;4; 1.000000, 0.000000, 0.000000, 0.000000;;,
+      314;4; 0.707107, 0.000000,-0.707107, 0.000000;;,
+      628;4; 0.000000, 0.000000,-1.000000, 0.000000;;,
+      942;4;-0.707107, 0.000000,-0.707107, 0.000000;;,
+      1257;4;-1.000000, 0.000000, 0.000000, 0.000000;;,
+      1571;4;-0.707107, 0.000000, 0.707107, 0.000000;;,
+      1885;4; 0.000000, 0.000000, 1.000000, 0.000000;;,
+      2199;4; 0.707107, 0.000000, 0.707107, 0.000000;;,
+      2513;4; 1.000000, 0.000000, 0.000000, 0.000000;;,
+      2827;4; 0.707107, 0.000000,-0.707107, 0.000000;;,
+      3142;4; 0.000000, 0.000000,-1.000000, 0.000000;;,
+      3456;4;-0.707107, 0.000000,-0.707107, 0.000000;;,
+      3770;4;-1.000000, 0.000000, 0.000000, 0.000000;;,
+      4084;4;-0.707107, 0.000000, 0.707107, 0.000000;;,
+      4398;4; 0.000000, 0.000000, 1.000000, 0.000000;;,
+      4712;4; 0.707107, 0.000000, 0.707107, 0.000000;;,
+      5027;4; 1.000000, 0.000000, 0.000000, 0.000000;;,
+      5341;4; 0.707107, 0.000000,-0.707107, 0.000000;;,
+      5655;4; 0.000000, 0.000000,-1.000000, 0.000000;;,
+      5969;4;-0.707107, 0.000000,-0.707107, 0.000000;;,
+      6283;4;-1.000000, 0.000000, 0.000000, 0.000000;;;
+    }
+  }
+} // End of AnimationSet Scan
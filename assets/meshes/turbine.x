@@ -16,6 +16,10 @@ template SkinWeights {
   Matrix4x4 matrixOffset;
 }
 
+AnimTicksPerSecond {
+  1000;
+}
+
 Frame Root {
   FrameTransformMatrix {
      1.000000, 0.000000, 0.000000, 0.000000,
@@ -2594,3 +2598,17 @@ Frame Root {
     } // End of Turbine
   } // End of Armature
 } // End of Root
+AnimationSet Spin {
+  Animation {
+    {Armature_Rotor}
+    AnimationKey { // Rotation
+      0;
+      5;
+      0;4;-0.500000, 0.500000, 0.500000, 0.500000;;,
+      1571;4; 0.000000, 0.707107, 0.707107, 0.000000;;,
+      3142;4; 0.500000, 0.500000, 0.500000,-0.500000;;,
+      4712;4; 0.707107, 0.000000, 0.000000,-0.707107;;,
+      6283;4; 0.500000,-0.500000,-0.500000,-0.500000;;;
+    }
+  }
+} // End of AnimationSet Spin
@@ -0,0 +1,9 @@
+// constants of the current frame; the layout must match FrameConstantsBlock
+layout(std140) uniform FrameConstants {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 camera_position;
+    vec4 ambient_light;
+    float time;
+};
@@ -3,7 +3,10 @@
 in vec3 position;
 in vec3 normal;
 in vec2 texture_coordinate;
+in uvec4 bone_ids;
 in vec4 weights;
+in uint instance_palette_offset;    // first bone of the pose of this instance
+in mat4 instance_model;             // model matrix of this instance
 
 out vec3 position_worldspace;
 out vec3 eye_cameraspace;
@@ -12,24 +15,41 @@ out vec3 normal_cameraspace;
 out vec3 position0;
 out vec2 texcoord0;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 mvp;
-uniform mat4 armature[3];
+#include "frame_constants.glsl"
+
+uniform samplerBuffer palettes;     // bone palettes of all objects, three texels per bone
+
+#include "vertex_decode.glsl"
+
+// fetch a bone matrix from the slice of this instance; only the first three
+// columns are stored, the last one of an affine bone is always (0,0,0,1)
+mat4 get_bone(uint idx) {
+    int base = int(instance_palette_offset + idx) * 3;
+    return mat4(texelFetch(palettes, base),
+                texelFetch(palettes, base + 1),
+                texelFetch(palettes, base + 2),
+                vec4(0.0, 0.0, 0.0, 1.0));
+}
 
 void main() {
     // output position of the vertex
     vec4 pos = vec4(0,0,0,1);
     vec4 nor = vec4(0,0,0,1);
 
-    for(int i=0; i<3; i++) {
-        pos += weights[i] * vec4(position, 1.0) * armature[i];
-        nor += weights[i] * vec4(normal, 0.0) * armature[i];
+    vec3 p = decode_position(position);
+    vec3 n = decode_normal(normal);
+
+    // blend the (up to) four bones influencing this vertex
+    for(int i=0; i<4; i++) {
+        mat4 bone = get_bone(bone_ids[i]);
+        pos += weights[i] * vec4(p, 1.0) * bone;
+        nor += weights[i] * vec4(n, 0.0) * bone;
     }
 
     vec4 new_pos =vec4(pos.xyz, 1.0);
 
-    gl_Position = mvp * new_pos;
+    mat4 model = instance_model;
+    gl_Position = view_projection * model * new_pos;
     position0 = new_pos.xyz;
     texcoord0 = texture_coordinate;
 
@@ -7,7 +7,7 @@ in  vec3 eye_cameraspace;
 in  vec3 lightdirection_cameraspace;
 in  vec3 normal_cameraspace;
 
-uniform vec4 ambient_light;
+#include "frame_constants.glsl"
 
 out vec4 fragColor;
 
@@ -9,7 +9,8 @@ in  vec3 normal_cameraspace;
 
 out vec4 fragColor;
 
-uniform vec4 ambient_light;
+#include "frame_constants.glsl"
+
 uniform sampler2D tex;
 
 void main() {
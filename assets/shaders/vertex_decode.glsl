@@ -0,0 +1,24 @@
+// decoding of the compact vertex formats (see Mesh::build_vertex_layout);
+// normalized integers, such as the bone weights, are expanded by the GL
+
+uniform vec3 position_offset;
+uniform vec3 position_scale;
+uniform float normal_encoding;
+
+// undo the bounding box quantization of the positions
+vec3 decode_position(vec3 p) {
+    return position_offset + p * position_scale;
+}
+
+// unfold octahedral encoded normals
+vec3 decode_normal(vec3 n) {
+    if(normal_encoding < 0.5) {
+        return n;
+    }
+
+    vec3 v = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+    float t = max(-v.z, 0.0);
+    v.x += v.x >= 0.0 ? -t : t;
+    v.y += v.y >= 0.0 ? -t : t;
+    return normalize(v);
+}
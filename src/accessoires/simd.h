@@ -0,0 +1,62 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef __SIMD_H
+#define __SIMD_H
+
+#include <cmath>
+
+// Minimal set of operations on four packed floats (SSE), with a scalar
+// fallback for targets without SSE. The fallback performs the same
+// operations in the same order, such that both give identical results.
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+
+typedef __m128 float4;
+
+static inline float4 f4_load(const float* p) { return _mm_loadu_ps(p); }
+static inline void f4_store(float* p, float4 a) { _mm_storeu_ps(p, a); }
+static inline float4 f4_set(float s) { return _mm_set1_ps(s); }
+static inline float4 f4_add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+static inline float4 f4_sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+static inline float4 f4_mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+// full precision 1/sqrt(a); the _mm_rsqrt_ps estimate would break the equality with the fallback
+static inline float4 f4_inv_sqrt(float4 a) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a)); }
+static inline float4 f4_sign(float4 a) { return _mm_or_ps(_mm_set1_ps(1.0f), _mm_and_ps(a, _mm_set1_ps(-0.0f))); }
+
+#else
+// scalar fallback performing the same operations lane by lane
+struct float4 {
+    float v[4];
+};
+
+static inline float4 f4_load(const float* p) { float4 r; for(unsigned int i=0; i<4; i++) { r.v[i] = p[i]; } return r; }
+static inline void f4_store(float* p, float4 a) { for(unsigned int i=0; i<4; i++) { p[i] = a.v[i]; } }
+static inline float4 f4_set(float s) { float4 r; for(unsigned int i=0; i<4; i++) { r.v[i] = s; } return r; }
+static inline float4 f4_add(float4 a, float4 b) { for(unsigned int i=0; i<4; i++) { a.v[i] += b.v[i]; } return a; }
+static inline float4 f4_sub(float4 a, float4 b) { for(unsigned int i=0; i<4; i++) { a.v[i] -= b.v[i]; } return a; }
+static inline float4 f4_mul(float4 a, float4 b) { for(unsigned int i=0; i<4; i++) { a.v[i] *= b.v[i]; } return a; }
+static inline float4 f4_inv_sqrt(float4 a) { for(unsigned int i=0; i<4; i++) { a.v[i] = 1.0f / std::sqrt(a.v[i]); } return a; }
+static inline float4 f4_sign(float4 a) { for(unsigned int i=0; i<4; i++) { a.v[i] = std::copysign(1.0f, a.v[i]); } return a; }
+#endif
+
+#endif // __SIMD_H
@@ -0,0 +1,408 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "animation.h"
+
+/**
+ * @brief      keys of four bones around the sampled time; every array
+ *             holds one component of a key for four bones
+ */
+struct SampleBatch {
+    float q0[4][4];     //!< rotation of the key before the sampled time
+    float q1[4][4];     //!< rotation of the key after the sampled time
+    float p0[3][4];     //!< position of the key before the sampled time
+    float p1[3][4];     //!< position of the key after the sampled time
+    float s0[3][4];     //!< scale of the key before the sampled time
+    float s1[3][4];     //!< scale of the key after the sampled time
+    float wq[4];        //!< interpolation weight of the rotations
+    float wp[4];        //!< interpolation weight of the positions
+    float ws[4];        //!< interpolation weight of the scales
+};
+
+static void gather_keys(const float* times, const glm::vec4* values, const AnimationChannel& channel, float time,
+                        unsigned int lane, unsigned int nr_components, float (*v0)[4], float (*v1)[4], float* w);
+static void blend_batch(const SampleBatch& b, float (*m)[4]);
+
+/**
+ * @brief      AnimationClip constructor
+ *
+ * @param[in]  _name  name of the clip
+ */
+AnimationClip::AnimationClip(const std::string& _name) {
+    this->name = _name;
+    this->duration = 0.0f;
+}
+
+/**
+ * @brief      AnimationClip constructor from stored keys
+ *
+ * @param[in]  _name    name of the clip
+ * @param[in]  _tracks  tracks
+ * @param[in]  _times   time of every key
+ * @param[in]  _values  value of every key
+ */
+AnimationClip::AnimationClip(const std::string& _name, const std::vector<AnimationTrack>& _tracks,
+                             const std::vector<float>& _times, const std::vector<glm::vec4>& _values) {
+    this->name = _name;
+    this->duration = 0.0f;
+    this->tracks = _tracks;
+    this->times = _times;
+    this->values = _values;
+}
+
+/**
+ * @brief      add the keys of a single channel of a bone
+ *
+ * @param[in]  bone        index of the bone
+ * @param[in]  channel     CHANNEL_ROTATION, CHANNEL_POSITION or CHANNEL_SCALE
+ * @param[in]  key_times   time of every key in seconds (ascending)
+ * @param[in]  key_values  value of every key
+ */
+void AnimationClip::add_channel(unsigned int bone, unsigned int channel, const std::vector<float>& key_times, const std::vector<glm::vec4>& key_values) {
+    AnimationTrack& track = this->get_track(bone);
+    AnimationChannel* channels[] = {&track.rotation, &track.position, &track.scale};
+
+    channels[channel]->first = this->times.size();
+    channels[channel]->count = key_times.size();
+    this->times.insert(this->times.end(), key_times.begin(), key_times.end());
+    this->values.insert(this->values.end(), key_values.begin(), key_values.end());
+}
+
+/**
+ * @brief      prepare the clip for sampling poses of an armature
+ *
+ * @param[in]  armature  armature the keys apply to
+ */
+void AnimationClip::bind(const Armature* armature) {
+    std::vector<AnimationTrack> bound;
+    this->frame_inverses.clear();
+
+    std::sort(this->tracks.begin(), this->tracks.end(), [](const AnimationTrack& a, const AnimationTrack& b) {
+        return a.bone < b.bone;
+    });
+
+    for(unsigned int i=0; i<this->tracks.size(); i++) {
+        AnimationTrack track = this->tracks[i];
+
+        if(track.bone >= armature->get_nr_bones() || armature->get_parent(track.bone) < 0) {
+            std::cerr << "Ignoring track of bone " << track.bone << " in animation clip " << this->name << std::endl;
+            continue;
+        }
+
+        // channels without keys keep the frame of the bone
+        const glm::mat4& frame = armature->get_frame_matrix(track.bone);
+        glm::vec4 rest[3];
+        decompose(glm::transpose(frame), &rest[0], &rest[1], &rest[2]);
+
+        AnimationChannel* channels[] = {&track.rotation, &track.position, &track.scale};
+        for(unsigned int j=0; j<3; j++) {
+            if(channels[j]->count == 0) {
+                channels[j]->first = this->times.size();
+                channels[j]->count = 1;
+                this->times.push_back(0.0f);
+                this->values.push_back(rest[j]);
+            }
+        }
+
+        bound.push_back(track);
+        this->frame_inverses.push_back(glm::inverse(frame));
+    }
+
+    this->tracks = bound;
+
+    this->duration = 0.0f;
+    for(unsigned int i=0; i<this->times.size(); i++) {
+        this->duration = std::max(this->duration, this->times[i]);
+    }
+}
+
+/**
+ * @brief      set the bone transformations of a pose at a point in time
+ *
+ * @param[in]  time  time in seconds (clamped to the clip)
+ * @param      pose  pose to write to
+ */
+void AnimationClip::sample(float time, Pose* pose) const {
+    time = std::min(std::max(time, 0.0f), this->duration);
+
+    SampleBatch batch;
+    float m[12][4];
+
+    for(unsigned int first=0; first<this->tracks.size(); first += 4) {
+        const unsigned int n = std::min((unsigned int)this->tracks.size() - first, 4u);
+
+        // unused lanes repeat the last track
+        for(unsigned int lane=0; lane<4; lane++) {
+            const AnimationTrack& track = this->tracks[first + std::min(lane, n - 1)];
+            gather_keys(&this->times[0], &this->values[0], track.rotation, time, lane, 4, batch.q0, batch.q1, batch.wq);
+            gather_keys(&this->times[0], &this->values[0], track.position, time, lane, 3, batch.p0, batch.p1, batch.wp);
+            gather_keys(&this->times[0], &this->values[0], track.scale, time, lane, 3, batch.s0, batch.s1, batch.ws);
+        }
+
+        blend_batch(batch, m);
+
+        // the keys describe the bone in the space of its parent (as the frame
+        // matrix does); the pose holds the transformation relative to the frame
+        for(unsigned int lane=0; lane<n; lane++) {
+            glm::mat4 local(1.0f);
+            for(unsigned int i=0; i<3; i++) {
+                for(unsigned int j=0; j<4; j++) {
+                    local[i][j] = m[i * 4 + j][lane];
+                }
+            }
+            pose->set_bone_transformation(this->tracks[first + lane].bone, local * this->frame_inverses[first + lane]);
+        }
+    }
+}
+
+/**
+ * @brief      split a transformation into rotation, translation and scale
+ *
+ * @param[in]  m         transformation (column vectors)
+ * @param[out] rotation  quaternion (x,y,z,w)
+ * @param[out] position  translation (x,y,z,0)
+ * @param[out] scale     scaling factors (x,y,z,0)
+ */
+void AnimationClip::decompose(const glm::mat4& m, glm::vec4* rotation, glm::vec4* position, glm::vec4* scale) {
+    const glm::vec3 s(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+    const glm::quat q = glm::quat_cast(glm::mat3(glm::vec3(m[0]) / s.x, glm::vec3(m[1]) / s.y, glm::vec3(m[2]) / s.z));
+
+    *rotation = glm::vec4(q.x, q.y, q.z, q.w);
+    *position = glm::vec4(glm::vec3(m[3]), 0.0f);
+    *scale = glm::vec4(s, 0.0f);
+}
+
+/**
+ * @brief      get the track of a bone, adding it if it does not exist
+ *
+ * @param[in]  bone  index of the bone
+ *
+ * @return     track
+ */
+AnimationTrack& AnimationClip::get_track(unsigned int bone) {
+    for(unsigned int i=0; i<this->tracks.size(); i++) {
+        if(this->tracks[i].bone == bone) {
+            return this->tracks[i];
+        }
+    }
+
+    AnimationTrack track;
+    track.bone = bone;
+    track.rotation.first = track.position.first = track.scale.first = 0;
+    track.rotation.count = track.position.count = track.scale.count = 0;
+    this->tracks.push_back(track);
+
+    return this->tracks.back();
+}
+
+/**
+ * @brief      AnimationPlayer constructor
+ */
+AnimationPlayer::AnimationPlayer() {
+    this->clip = NULL;
+    this->time = 0.0f;
+    this->speed = 1.0f;
+    this->flag_loop = true;
+}
+
+/**
+ * @brief      start playing a clip from the beginning
+ *
+ * @param[in]  _clip   clip to play
+ * @param[in]  _speed  playback speed
+ * @param[in]  loop    whether to restart at the end of the clip
+ */
+void AnimationPlayer::play(const AnimationClip* _clip, float _speed, bool loop) {
+    this->clip = _clip;
+    this->speed = _speed;
+    this->flag_loop = loop;
+    this->time = (_clip && _speed < 0.0f) ? _clip->get_duration() : 0.0f;
+}
+
+/**
+ * @brief      advance the clip
+ *
+ * @param[in]  dt    elapsed time in seconds
+ */
+void AnimationPlayer::update(double dt) {
+    if(!this->clip) {
+        return;
+    }
+
+    const float duration = this->clip->get_duration();
+    this->time += (float)dt * this->speed;
+
+    if(this->flag_loop && duration > 0.0f) {
+        this->time = std::fmod(this->time, duration);
+        if(this->time < 0.0f) {
+            this->time += duration;
+        }
+    } else {
+        this->time = std::min(std::max(this->time, 0.0f), duration);
+    }
+}
+
+/**
+ * @brief      write the current pose of the clip
+ *
+ * @param      pose  pose to write to
+ */
+void AnimationPlayer::apply(Pose* pose) const {
+    if(this->clip && pose) {
+        this->clip->sample(this->time, pose);
+    }
+}
+
+/**
+ * @brief      whether a non-looping clip reached its end
+ *
+ * @return     true if the clip has finished
+ */
+bool AnimationPlayer::is_finished() const {
+    if(!this->clip || this->flag_loop) {
+        return false;
+    }
+
+    return this->speed >= 0.0f ? this->time >= this->clip->get_duration() : this->time <= 0.0f;
+}
+
+/**
+ * @brief      collect the keys of a channel around a point in time
+ *
+ * @param[in]  times          time of every key
+ * @param[in]  values         value of every key
+ * @param[in]  channel        channel to sample
+ * @param[in]  time           time in seconds
+ * @param[in]  lane           lane of the batch to write to
+ * @param[in]  nr_components  number of components of the values
+ * @param[out] v0             value of the key before the time
+ * @param[out] v1             value of the key after the time
+ * @param[out] w              interpolation weight
+ */
+static void gather_keys(const float* times, const glm::vec4* values, const AnimationChannel& channel, float time,
+                        unsigned int lane, unsigned int nr_components, float (*v0)[4], float (*v1)[4], float* w) {
+    const float* begin = times + channel.first;
+    const float* end = begin + channel.count;
+
+    unsigned int k1 = std::upper_bound(begin, end, time) - begin;
+    const unsigned int k0 = (k1 > 0) ? k1 - 1 : 0;
+    k1 = std::min(k1, channel.count - 1);
+
+    const float span = begin[k1] - begin[k0];
+    w[lane] = (span > 0.0f) ? (time - begin[k0]) / span : 0.0f;
+
+    const glm::vec4& a = values[channel.first + k0];
+    const glm::vec4& b = values[channel.first + k1];
+    for(unsigned int i=0; i<nr_components; i++) {
+        v0[i][lane] = a[i];
+        v1[i][lane] = b[i];
+    }
+}
+
+/**
+ * @brief      interpolate the keys of four bones
+ *
+ * @param[in]  b     keys of the bones
+ * @param[out] m     first three columns of the local transformation (row
+ *                   vectors) of every bone; m[i * 4 + j][lane]
+ */
+static void blend_batch(const SampleBatch& b, float (*m)[4]) {
+    float4 qa[4], qb[4];
+    for(unsigned int i=0; i<4; i++) {
+        qa[i] = f4_load(b.q0[i]);
+        qb[i] = f4_load(b.q1[i]);
+    }
+
+    float4 d = f4_mul(qa[0], qb[0]);
+    for(unsigned int i=1; i<4; i++) {
+        d = f4_add(d, f4_mul(qa[i], qb[i]));
+    }
+
+    // take the shortest arc
+    const float4 sign = f4_sign(d);
+    d = f4_mul(d, sign);
+    for(unsigned int i=0; i<4; i++) {
+        qb[i] = f4_mul(qb[i], sign);
+    }
+
+    // adjust the interpolation parameter such that the normalized lerp
+    // follows the arc at constant speed (fitted to slerp)
+    const float4 t = f4_load(b.wq);
+    const float4 half = f4_set(0.5f);
+    const float4 ca = f4_add(f4_set(1.0904f), f4_mul(d, f4_add(f4_set(-3.2452f), f4_mul(d, f4_sub(f4_set(3.55645f), f4_mul(d, f4_set(1.43519f)))))));
+    const float4 cb = f4_add(f4_set(0.848013f), f4_mul(d, f4_add(f4_set(-1.06021f), f4_mul(d, f4_set(0.215638f)))));
+    const float4 th = f4_sub(t, half);
+    const float4 k = f4_add(f4_mul(ca, f4_mul(th, th)), cb);
+    const float4 u = f4_add(t, f4_mul(f4_mul(t, th), f4_mul(f4_sub(t, f4_set(1.0f)), k)));
+
+    float4 q[4];
+    for(unsigned int i=0; i<4; i++) {
+        q[i] = f4_add(qa[i], f4_mul(f4_sub(qb[i], qa[i]), u));
+    }
+    float4 l2 = f4_mul(q[0], q[0]);
+    for(unsigned int i=1; i<4; i++) {
+        l2 = f4_add(l2, f4_mul(q[i], q[i]));
+    }
+    const float4 n = f4_inv_sqrt(l2);
+    for(unsigned int i=0; i<4; i++) {
+        q[i] = f4_mul(q[i], n);
+    }
+
+    float4 p[3], s[3];
+    const float4 wp = f4_load(b.wp);
+    const float4 ws = f4_load(b.ws);
+    for(unsigned int i=0; i<3; i++) {
+        const float4 pa = f4_load(b.p0[i]);
+        const float4 sa = f4_load(b.s0[i]);
+        p[i] = f4_add(pa, f4_mul(f4_sub(f4_load(b.p1[i]), pa), wp));
+        s[i] = f4_add(sa, f4_mul(f4_sub(f4_load(b.s1[i]), sa), ws));
+    }
+
+    // rotation matrix of the quaternions
+    const float4 two = f4_set(2.0f);
+    const float4 one = f4_set(1.0f);
+    const float4 x2 = f4_mul(q[0], two);
+    const float4 y2 = f4_mul(q[1], two);
+    const float4 z2 = f4_mul(q[2], two);
+    const float4 xx = f4_mul(q[0], x2);
+    const float4 yy = f4_mul(q[1], y2);
+    const float4 zz = f4_mul(q[2], z2);
+    const float4 xy = f4_mul(q[0], y2);
+    const float4 xz = f4_mul(q[0], z2);
+    const float4 yz = f4_mul(q[1], z2);
+    const float4 wx = f4_mul(q[3], x2);
+    const float4 wy = f4_mul(q[3], y2);
+    const float4 wz = f4_mul(q[3], z2);
+
+    // r[c][r] for column vectors; the armature uses the transpose
+    const float4 r[3][3] = {
+        {f4_sub(one, f4_add(yy, zz)), f4_add(xy, wz), f4_sub(xz, wy)},
+        {f4_sub(xy, wz), f4_sub(one, f4_add(xx, zz)), f4_add(yz, wx)},
+        {f4_add(xz, wy), f4_sub(yz, wx), f4_sub(one, f4_add(xx, yy))}
+    };
+
+    for(unsigned int i=0; i<3; i++) {
+        for(unsigned int j=0; j<3; j++) {
+            f4_store(m[i * 4 + j], f4_mul(r[j][i], s[j]));
+        }
+        f4_store(m[i * 4 + 3], p[i]);
+    }
+}
@@ -0,0 +1,278 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _ANIMATION_H
+#define _ANIMATION_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "accessoires/simd.h"
+#include "core/armature.h"
+#include "core/pose.h"
+
+/**
+ * @brief      range of keys of a single channel in an AnimationClip
+ */
+struct AnimationChannel {
+    uint32_t first;     //!< index of the first key
+    uint32_t count;     //!< number of keys
+};
+
+/**
+ * @brief      keys that animate a single bone
+ */
+struct AnimationTrack {
+    uint32_t bone;                  //!< index of the bone in the armature
+    AnimationChannel rotation;      //!< quaternions (x,y,z,w)
+    AnimationChannel position;      //!< translations (x,y,z,0)
+    AnimationChannel scale;         //!< scaling factors (x,y,z,0)
+};
+
+/**
+ * @brief      keyframe animation of an armature
+ *
+ * The keys of all tracks are stored in two flat arrays (times and values);
+ * every track refers to a range of these per channel. Keys are given in
+ * the space of the parent bone, like the frame matrices of the armature.
+ *
+ * Sampling handles four bones at once: rotations are interpolated by a
+ * normalized lerp with a correction of the interpolation parameter that
+ * closely follows slerp, which maps directly onto SIMD instructions.
+ */
+class AnimationClip {
+private:
+    std::string name;                               //!< name of the clip
+    float duration;                                 //!< time of the last key in seconds
+
+    std::vector<AnimationTrack> tracks;             //!< tracks ordered by bone
+    std::vector<float> times;                       //!< time of every key in seconds
+    std::vector<glm::vec4> values;                  //!< value of every key
+    std::vector<glm::mat4> frame_inverses;          //!< inverse frame matrix of the bone of every track
+
+public:
+    static const unsigned int CHANNEL_ROTATION  = 0;
+    static const unsigned int CHANNEL_POSITION  = 1;
+    static const unsigned int CHANNEL_SCALE     = 2;
+
+    /**
+     * @brief      AnimationClip constructor
+     *
+     * @param[in]  _name  name of the clip
+     */
+    AnimationClip(const std::string& _name);
+
+    /**
+     * @brief      AnimationClip constructor from stored keys
+     *
+     * @param[in]  _name    name of the clip
+     * @param[in]  _tracks  tracks
+     * @param[in]  _times   time of every key
+     * @param[in]  _values  value of every key
+     */
+    AnimationClip(const std::string& _name, const std::vector<AnimationTrack>& _tracks,
+                  const std::vector<float>& _times, const std::vector<glm::vec4>& _values);
+
+    /**
+     * @brief      add the keys of a single channel of a bone
+     *
+     * @param[in]  bone        index of the bone
+     * @param[in]  channel     CHANNEL_ROTATION, CHANNEL_POSITION or CHANNEL_SCALE
+     * @param[in]  key_times   time of every key in seconds (ascending)
+     * @param[in]  key_values  value of every key
+     */
+    void add_channel(unsigned int bone, unsigned int channel, const std::vector<float>& key_times, const std::vector<glm::vec4>& key_values);
+
+    /**
+     * @brief      prepare the clip for sampling poses of an armature
+     *
+     *             Channels without keys keep the value of the frame matrix.
+     *             Root bones cannot be animated (the object places them).
+     *
+     * @param[in]  armature  armature the keys apply to
+     */
+    void bind(const Armature* armature);
+
+    /**
+     * @brief      set the bone transformations of a pose at a point in time
+     *
+     * @param[in]  time  time in seconds (clamped to the clip)
+     * @param      pose  pose to write to
+     */
+    void sample(float time, Pose* pose) const;
+
+    /**
+     * @brief      split a transformation into rotation, translation and scale
+     *
+     * @param[in]  m         transformation (column vectors)
+     * @param[out] rotation  quaternion (x,y,z,w)
+     * @param[out] position  translation (x,y,z,0)
+     * @param[out] scale     scaling factors (x,y,z,0)
+     */
+    static void decompose(const glm::mat4& m, glm::vec4* rotation, glm::vec4* position, glm::vec4* scale);
+
+    /**
+     * @brief      get the name of the clip
+     *
+     * @return     name
+     */
+    inline const std::string& get_name() const {
+        return this->name;
+    }
+
+    /**
+     * @brief      get the duration of the clip
+     *
+     * @return     duration in seconds
+     */
+    inline float get_duration() const {
+        return this->duration;
+    }
+
+    /**
+     * @brief      get the tracks
+     *
+     * @return     tracks
+     */
+    inline const std::vector<AnimationTrack>& get_tracks() const {
+        return this->tracks;
+    }
+
+    /**
+     * @brief      get the time of every key
+     *
+     * @return     key times
+     */
+    inline const std::vector<float>& get_times() const {
+        return this->times;
+    }
+
+    /**
+     * @brief      get the value of every key
+     *
+     * @return     key values
+     */
+    inline const std::vector<glm::vec4>& get_values() const {
+        return this->values;
+    }
+
+private:
+    /**
+     * @brief      get the track of a bone, adding it if it does not exist
+     *
+     * @param[in]  bone  index of the bone
+     *
+     * @return     track
+     */
+    AnimationTrack& get_track(unsigned int bone);
+};
+
+/**
+ * @brief      playback of an AnimationClip
+ */
+class AnimationPlayer {
+private:
+    const AnimationClip* clip;      //!< clip that is played (NULL if none)
+    float time;                     //!< position in the clip in seconds
+    float speed;                    //!< playback speed (1.0 is real time; negative plays backwards)
+    bool flag_loop;                 //!< whether to restart at the end of the clip
+
+public:
+    /**
+     * @brief      AnimationPlayer constructor
+     */
+    AnimationPlayer();
+
+    /**
+     * @brief      start playing a clip from the beginning
+     *
+     * @param[in]  _clip   clip to play
+     * @param[in]  _speed  playback speed
+     * @param[in]  loop    whether to restart at the end of the clip
+     */
+    void play(const AnimationClip* _clip, float _speed = 1.0f, bool loop = true);
+
+    /**
+     * @brief      advance the clip
+     *
+     * @param[in]  dt    elapsed time in seconds
+     */
+    void update(double dt);
+
+    /**
+     * @brief      write the current pose of the clip
+     *
+     * @param      pose  pose to write to
+     */
+    void apply(Pose* pose) const;
+
+    /**
+     * @brief      whether a non-looping clip reached its end
+     *
+     * @return     true if the clip has finished
+     */
+    bool is_finished() const;
+
+    /**
+     * @brief      get the clip that is played
+     *
+     * @return     clip (NULL if none)
+     */
+    inline const AnimationClip* get_clip() const {
+        return this->clip;
+    }
+
+    /**
+     * @brief      get the position in the clip
+     *
+     * @return     time in seconds
+     */
+    inline float get_time() const {
+        return this->time;
+    }
+
+    /**
+     * @brief      set the position in the clip
+     *
+     * @param[in]  _time  time in seconds
+     */
+    inline void set_time(float _time) {
+        this->time = _time;
+    }
+
+    /**
+     * @brief      set the playback speed
+     *
+     * @param[in]  _speed  playback speed
+     */
+    inline void set_speed(float _speed) {
+        this->speed = _speed;
+    }
+};
+
+#endif // _ANIMATION_H
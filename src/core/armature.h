@@ -30,185 +30,123 @@
 #include <glm/ext.hpp>
 
 /**
- * @brief      Bone class as nested class in Armature
+ * @brief      Armature class that handles skeletal animation
+ *
+ * Bones are stored as parallel arrays in topological order: a parent always
+ * precedes its children. A pose is therefore evaluated in a single forward
+ * pass, in which every bone reuses the global transformation of its parent.
+ *
+ * The armature only describes the skeleton and is shared by every object
+ * that uses the same mesh; the pose of an object lives in a Pose.
  */
-class Bone {
-private:
-    const Bone* parent;         //! < pointer to parent
-    glm::mat4 matrix_offset;    //! < matrix to transform from model space to this bone space
-    glm::mat4 matrix_frame;     //! < matrix to transform from this bone space to the parent's bone
-                                //! space
-    std::string name;           //! < bone name
-
-    std::vector<float> weights; //! < vector holding weights
+class Armature {
 
-    unsigned int id;
+private:
+    std::vector<std::string> names;                 //!< name of every bone
+    std::vector<int> parents;                       //!< index of the parent of every bone (-1 for roots)
+    std::vector<glm::mat4> frame_matrices;          //!< transform from bone space to the parent's bone space
+    std::vector<glm::mat4> offset_matrices;         //!< transform from model space to bone space
 
 public:
 
     /**
-     * @brief      default constructor
-     *
-     * @param[in]  frame    frame matrix to transform from this frame to the
-     *                      parent's frame
-     * @param[in]  _name    name of the bone
-     * @param[in]  _parent  pointer to the parent Bone (NULL if this is root)
-     *
+     * @brief      Armature constructor
      */
-    Bone(const glm::mat4& frame, const std::string& _name, const Bone* _parent);
+    Armature();
 
     /**
-     * @brief      Get the name.
+     * @brief      add a bone to the armature
      *
-     * @return     The name.
-     */
-    inline const std::string& get_name() const {
-        return this->name;
-    }
-
-    /**
-     * @brief      Set the offset matrix.
+     * @param[in]  frame   matrix defining the frame transformation
+     * @param[in]  _name   name of the bone
+     * @param[in]  parent  index of the parent bone (-1 if none); needs to
+     *                     be added before its children
      *
-     * @param[in]  _offset_matrix  The offset matrix
+     * @return     index of the bone
      */
-    void set_offset_matrix(const glm::mat4& _offset_matrix);
+    unsigned int add_bone(const glm::mat4& frame, const std::string& _name, int parent);
 
-    inline void set_frame_matrix(const glm::mat4& _frame_matrix) {
-        this->matrix_frame = _frame_matrix;
-    }
+    unsigned int find_bone_by_name(const std::string& _name) const;
 
-    inline void set_idx(unsigned int _id) {
-        this->id = _id;
-    }
+    void build_frame_matrices();
 
     /**
-     * @brief      Set the weights.
+     * @brief      evaluate the vertex multiplication matrices of a pose
      *
-     * @param[in]  _weights  The weights
-     */
-    inline void set_weights(const std::vector<float>& _weights) {
-        this->weights = _weights;
-    }
-
-    inline unsigned int get_idx() const {
-        return this->id;
-    }
-
-    /**
-     * @brief      Get the weights.
+     *             Costs three matrix products per bone, regardless of the
+     *             depth of the hierarchy. All matrices are affine in the
+     *             row vector convention, i.e. their last column is
+     *             (0,0,0,1), such that the palette can be sent to the GPU
+     *             as 3x4 matrices (see PaletteBuffer).
      *
-     * @return     The weights.
+     * @param[in]  transformations  pose of every bone in its own space
+     * @param[out] palette          vertex multiplication matrix of every bone
      */
-    inline const std::vector<float>& get_weights() {
-        return this->weights;
-    }
+    void evaluate(const glm::mat4* transformations, glm::mat4* palette) const;
 
-    /**
-     * @brief      Get size of weights vector
-     *
-     * @return     weight vector size
-     */
-    inline unsigned int get_weights_size() const {
-        return this->weights.size();
-    }
+    static const unsigned int MAX_BONES = 256;  //!< number of bones addressable by the 8 bit bone indices
 
     /**
-     * @brief      Get the frame matrix.
+     * @brief      get number of bones in armature
      *
-     * @return     Frame matrix.
+     * @return     number of bones in armature
      */
-    inline const glm::mat4& get_frame_matrix() const {
-        return this->matrix_frame;
+    inline unsigned int get_nr_bones() const {
+        return this->names.size();
     }
 
     /**
-     * @brief      Get the offset matrix.
+     * @brief      Get the name of a bone.
      *
-     * @return     Offset matrix.
-     */
-    inline const glm::mat4& get_offset_matrix() const {
-        return this->matrix_offset;
-    }
-
-    /**
-     * @brief      Get the parent.
+     * @param[in]  idx   The idx
      *
-     * @return     The parent.
+     * @return     The name.
      */
-    inline const Bone* get_parent() const {
-        return this->parent;
+    inline const std::string& get_name(unsigned int idx) const {
+        return this->names[idx];
     }
 
-private:
-};
-
-/**
- * @brief      Armature class that handles skeletal animation
- */
-class Armature {
-
-private:
-    std::vector<Bone*> bones;        //!< vector holding all bones in armature
-    std::vector<glm::mat4> glsl_matrices;
-    std::vector<glm::mat4> bone_transformations;
-
-public:
-
     /**
-     * @brief      Armature constructor
-     */
-    Armature();
-
-    /**
-     * @brief      add a bone to the armature
+     * @brief      Get the parent of a bone.
      *
-     * @param[in]  frame      matrix defining the frame transformation
-     * @param[in]  _name      name of the bone
-     * @param[in]  parent_id  pointer to the parent bone (NULL is none)
+     * @param[in]  idx   The idx
      *
-     * @return     pointer to the bone instance
+     * @return     index of the parent (-1 if the bone is a root)
      */
-    Bone* add_bone(const glm::mat4& frame, const std::string& _name, const Bone* parent_id);
-
-    unsigned int find_bone_by_name(const std::string& _name) const;
-
-    void build_frame_matrices();
-
-    void build_glsl_matrices();
-
-    inline void set_bone_transformation(unsigned int idx, const glm::mat4& m) {
-        this->bone_transformations[idx] = m;
+    inline int get_parent(unsigned int idx) const {
+        return this->parents[idx];
     }
 
     /**
-     * @brief      get number of bones in armature
+     * @brief      Get the frame matrix of a bone.
      *
-     * @return     number of bones in armature
+     * @param[in]  idx   The idx
+     *
+     * @return     Frame matrix.
      */
-    inline unsigned int get_nr_bones() const {
-        return this->bones.size();
+    inline const glm::mat4& get_frame_matrix(unsigned int idx) const {
+        return this->frame_matrices[idx];
     }
 
     /**
-     * @brief      Get the bone by idx.
+     * @brief      Get the offset matrix of a bone.
      *
      * @param[in]  idx   The idx
      *
-     * @return     The bone by idx.
+     * @return     Offset matrix.
      */
-    inline Bone* get_bone_by_idx(unsigned int idx) const {
-        return this->bones[idx];
+    inline const glm::mat4& get_offset_matrix(unsigned int idx) const {
+        return this->offset_matrices[idx];
     }
 
     /**
-     * @brief      Get the weights vector.
+     * @brief      Set the offset matrix of a bone.
      *
-     * @return     The weights vector.
+     * @param[in]  idx            The idx
+     * @param[in]  offset_matrix  The offset matrix
      */
-    std::vector<float> get_weights_vector() const;
-
-    const std::vector<glm::mat4>& get_glsl_matrices() const {
-        return this->glsl_matrices;
+    inline void set_offset_matrix(unsigned int idx, const glm::mat4& offset_matrix) {
+        this->offset_matrices[idx] = offset_matrix;
     }
 
     /**
@@ -219,11 +157,11 @@ public:
     /**
      * @brief      get the path of a bone
      *
-     * @param[in]  bone  pointer to bone instance
+     * @param[in]  idx   index of the bone
      *
      * @return     string containin bone path.
      */
-    std::string get_bone_path(const Bone* bone) const;
+    std::string get_bone_path(unsigned int idx) const;
 
 private:
 
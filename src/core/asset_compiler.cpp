@@ -0,0 +1,482 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "asset_compiler.h"
+
+const char* AssetCompiler::ASSET_ROOT = "assets";
+const char* AssetCompiler::CACHE_DIR = "compiled";
+
+// get the asset type of a file from its extension (NUM_ASSET_TYPES if unknown)
+static unsigned int get_asset_type(const std::string& filename);
+
+// get the extension appended to a compiled asset
+static std::string get_compiled_extension(unsigned int type);
+
+// recursively list all regular files below a directory
+static void list_files(const std::string& path, const std::string& skip, std::vector<std::string>* files);
+
+// create a directory and all of its parents
+static bool make_directories(const std::string& path);
+
+// read a file into a string
+static bool read_file(const std::string& filename, std::string* contents);
+
+// 64 bit FNV-1a hash
+static uint64_t fnv1a(const std::string& data, uint64_t hash = 0xcbf29ce484222325ULL);
+
+// modification time of a file (zero if the file does not exist)
+static time_t get_modification_time(const std::string& filename);
+
+/**
+ * @brief      AssetCompiler constructor
+ *
+ * @param[in]  _root  root of the asset tree
+ */
+AssetCompiler::AssetCompiler(const std::string& _root) {
+    this->root = _root;
+    while(this->root.size() > 1 && this->root.back() == '/') {
+        this->root.pop_back();
+    }
+
+    this->next_job = 0;
+    this->nr_failed = 0;
+    this->load_manifest();
+}
+
+/**
+ * @brief      collect all assets that are new or have changed
+ *
+ * @param[in]  force  rebuild all assets regardless of the manifest
+ *
+ * @return     number of assets to compile
+ */
+unsigned int AssetCompiler::scan(bool force) {
+    const std::string cache = this->root + "/" + CACHE_DIR;
+
+    std::vector<std::string> files;
+    list_files(this->root, cache, &files);
+
+    this->jobs.clear();
+    for(unsigned int i=0; i<files.size(); i++) {
+        CompileJob job;
+        job.type = get_asset_type(files[i]);
+        if(job.type == NUM_ASSET_TYPES) {
+            continue;
+        }
+
+        std::string contents;
+        if(!read_file(files[i], &contents)) {
+            std::cerr << "Unable to read asset: " << files[i] << std::endl;
+            this->nr_failed++;
+            continue;
+        }
+
+        // the hash covers the output formats as well, such that format changes trigger a rebuild
+        const uint32_t versions[] = {FORMAT_VERSION, Mesh::BINARY_FILE_VERSION, Texture::RAW_FILE_VERSION};
+        job.source = files[i];
+        job.output = cache + files[i].substr(this->root.size()) + get_compiled_extension(job.type);
+        job.hash = fnv1a(contents, fnv1a(std::string((const char*)versions, sizeof(versions))));
+
+        std::map<std::string, uint64_t>::const_iterator it = this->manifest.find(job.output);
+        if(!force && it != this->manifest.end() && it->second == job.hash && get_modification_time(job.output) != 0) {
+            continue;
+        }
+
+        this->jobs.push_back(job);
+    }
+
+    return this->jobs.size();
+}
+
+/**
+ * @brief      compile the collected assets
+ *
+ * @param[in]  nr_threads  number of worker threads
+ *
+ * @return     number of assets that failed to compile
+ */
+unsigned int AssetCompiler::compile(unsigned int nr_threads) {
+    this->next_job = 0;
+
+    std::vector<std::thread> workers;
+    for(unsigned int i=0; i<std::max(1u, nr_threads); i++) {
+        workers.push_back(std::thread(&AssetCompiler::worker_loop, this));
+    }
+    for(unsigned int i=0; i<workers.size(); i++) {
+        workers[i].join();
+    }
+
+    this->save_manifest();
+
+    return this->nr_failed;
+}
+
+/**
+ * @brief      get the path of the compiled counterpart of an asset
+ *
+ * @param[in]  filename  path to the source (shaders without extension)
+ *
+ * @return     path inside CACHE_DIR, or an empty string if the asset lies
+ *             outside of the asset tree
+ */
+std::string AssetCompiler::get_compiled_path(const std::string& filename) {
+    const std::string root_dir = std::string(ASSET_ROOT) + "/";
+
+    // the asset root is either the first or the last directory of the path
+    size_t pos = std::string::npos;
+    if(boost::algorithm::starts_with(filename, root_dir)) {
+        pos = 0;
+    } else {
+        pos = filename.rfind("/" + root_dir);
+        if(pos != std::string::npos) {
+            pos++;
+        }
+    }
+
+    if(pos == std::string::npos) {
+        return "";
+    }
+
+    const size_t split = pos + root_dir.size();
+    return filename.substr(0, split) + CACHE_DIR + "/" + filename.substr(split) + get_compiled_extension(get_asset_type(filename));
+}
+
+/**
+ * @brief      resolve an asset to its compiled counterpart
+ *
+ * @param[in]  filename  path to the source
+ *
+ * @return     compiled path if it is at least as new as the source and
+ *             has the current format, otherwise the source path
+ */
+std::string AssetCompiler::find_compiled(const std::string& filename) {
+    const std::string compiled = get_compiled_path(filename);
+    if(compiled.empty()) {
+        return filename;
+    }
+
+    const time_t compiled_time = get_modification_time(compiled);
+    if(compiled_time == 0 || compiled_time < get_modification_time(filename)) {
+        return filename;
+    }
+
+    // files written by an older isana-assetc are ignored until they are rebuilt
+    switch(get_asset_type(filename)) {
+        case ASSET_MESH:
+            return Mesh::is_binary_file_current(compiled) ? compiled : filename;
+        case ASSET_TEXTURE:
+            return Texture::is_raw_file_current(compiled) ? compiled : filename;
+        default:
+            return compiled;
+    }
+}
+
+/**
+ * @brief      resolve a shader to its compiled counterpart
+ *
+ * @param[in]  filename  path to the shader files (without extension)
+ *
+ * @return     compiled path (without extension) if both stages are up to
+ *             date, otherwise the source path
+ */
+std::string AssetCompiler::find_compiled_shader(const std::string& filename) {
+    const std::string compiled = get_compiled_path(filename);
+    if(compiled.empty() ||
+       find_compiled(filename + ".vs") != compiled + ".vs" ||
+       find_compiled(filename + ".fs") != compiled + ".fs") {
+        return filename;
+    }
+
+    return compiled;
+}
+
+/**
+ * @brief      strip comments, trailing whitespace and blank lines
+ *
+ * @param[in]  source  shader source
+ *
+ * @return     preprocessed shader source
+ */
+std::string AssetCompiler::preprocess_shader(const std::string& source) {
+    std::string stripped;
+    stripped.reserve(source.size());
+
+    // remove comments, keeping the line breaks of block comments
+    bool block_comment = false;
+    for(size_t i=0; i<source.size(); i++) {
+        if(block_comment) {
+            if(source.compare(i, 2, "*/") == 0) {
+                block_comment = false;
+                i++;
+            } else if(source[i] == '\n') {
+                stripped += '\n';
+            }
+        } else if(source.compare(i, 2, "/*") == 0) {
+            block_comment = true;
+            i++;
+        } else if(source.compare(i, 2, "//") == 0) {
+            while(i+1 < source.size() && source[i+1] != '\n') {
+                i++;
+            }
+        } else if(source[i] != '\r') {
+            stripped += source[i];
+        }
+    }
+
+    std::vector<std::string> lines;
+    boost::algorithm::split(lines, stripped, boost::is_any_of("\n"));
+
+    std::string output;
+    for(unsigned int i=0; i<lines.size(); i++) {
+        boost::algorithm::trim_right(lines[i]);
+        if(!lines[i].empty()) {
+            output += lines[i] + "\n";
+        }
+    }
+
+    return output;
+}
+
+/**
+ * @brief      loop executed by every worker thread
+ */
+void AssetCompiler::worker_loop() {
+    while(true) {
+        const unsigned int i = this->next_job++;
+        if(i >= this->jobs.size()) {
+            return;
+        }
+
+        const CompileJob& job = this->jobs[i];
+        const bool success = this->compile_job(job);
+
+        std::lock_guard<std::mutex> lock(this->output_mutex);
+        if(success) {
+            this->manifest[job.output] = job.hash;
+            std::cout << "[" << (i+1) << "/" << this->jobs.size() << "] " << job.source << " -> " << job.output << std::endl;
+        } else {
+            this->manifest.erase(job.output);
+            this->nr_failed++;
+            std::cerr << "Failed to compile " << job.source << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief      convert a single asset
+ *
+ * @param[in]  job   conversion
+ *
+ * @return     true on success
+ */
+bool AssetCompiler::compile_job(const CompileJob& job) const {
+    if(!make_directories(job.output.substr(0, job.output.find_last_of('/')))) {
+        return false;
+    }
+
+    // write next to the output and rename, such that readers never see a partial file
+    const std::string tmp = job.output + ".tmp";
+    bool success = false;
+
+    switch(job.type) {
+        case ASSET_MESH: {
+            Mesh mesh;
+            success = mesh.load_mesh_from_file(job.source) && mesh.save_binary_file(tmp);
+        }
+        break;
+        case ASSET_TEXTURE: {
+            Texture texture;
+            success = texture.decode(job.source) && texture.save_raw_file(tmp);
+        }
+        break;
+        case ASSET_SHADER: {
+            std::string source;
+            success = read_file(job.source, &source);
+            if(success) {
+                std::ofstream f(tmp.c_str(), std::ios::binary | std::ios::trunc);
+                f << preprocess_shader(source);
+                success = f.good();
+            }
+        }
+        break;
+        default:
+            // do nothing
+        break;
+    }
+
+    if(!success || rename(tmp.c_str(), job.output.c_str()) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief      read the manifest of the previous run
+ */
+void AssetCompiler::load_manifest() {
+    std::ifstream f(this->get_manifest_path().c_str());
+
+    std::string line;
+    while(getline(f, line)) {
+        const size_t pos = line.find(' ');
+        if(pos == std::string::npos) {
+            continue;
+        }
+
+        this->manifest[line.substr(pos + 1)] = strtoull(line.substr(0, pos).c_str(), NULL, 16);
+    }
+}
+
+/**
+ * @brief      write the manifest
+ */
+void AssetCompiler::save_manifest() const {
+    make_directories(this->root + "/" + CACHE_DIR);
+
+    std::ofstream f(this->get_manifest_path().c_str(), std::ios::trunc);
+    for(std::map<std::string, uint64_t>::const_iterator it = this->manifest.begin(); it != this->manifest.end(); ++it) {
+        f << boost::format("%016x %s") % it->second % it->first << std::endl;
+    }
+}
+
+/**
+ * @brief      get the path to the manifest
+ *
+ * @return     path
+ */
+std::string AssetCompiler::get_manifest_path() const {
+    return this->root + "/" + CACHE_DIR + "/manifest";
+}
+
+static unsigned int get_asset_type(const std::string& filename) {
+    const size_t pos = filename.find_last_of("./");
+    if(pos == std::string::npos || filename[pos] != '.') {
+        return AssetCompiler::NUM_ASSET_TYPES;
+    }
+
+    const std::string ext = boost::algorithm::to_lower_copy(filename.substr(pos));
+
+    if(ext == ".x" || ext == ".mesh" || ext == ".obj") {
+        return AssetCompiler::ASSET_MESH;
+    }
+    if(ext == ".png") {
+        return AssetCompiler::ASSET_TEXTURE;
+    }
+    if(ext == ".vs" || ext == ".fs" || ext == ".glsl") {
+        return AssetCompiler::ASSET_SHADER;
+    }
+
+    return AssetCompiler::NUM_ASSET_TYPES;
+}
+
+static std::string get_compiled_extension(unsigned int type) {
+    switch(type) {
+        case AssetCompiler::ASSET_MESH:
+            return ".imesh";
+        case AssetCompiler::ASSET_TEXTURE:
+            return ".itex";
+        default:
+            // shaders keep their name
+            return "";
+    }
+}
+
+static void list_files(const std::string& path, const std::string& skip, std::vector<std::string>* files) {
+    DIR* dir = opendir(path.c_str());
+    if(dir == NULL) {
+        return;
+    }
+
+    std::vector<std::string> entries;
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL) {
+        const std::string name(entry->d_name);
+        if(name != "." && name != "..") {
+            entries.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    // visit the tree in a stable order
+    std::sort(entries.begin(), entries.end());
+
+    for(unsigned int i=0; i<entries.size(); i++) {
+        const std::string child = path + "/" + entries[i];
+        if(child == skip) {
+            continue;
+        }
+
+        struct stat st;
+        if(stat(child.c_str(), &st) != 0) {
+            continue;
+        }
+
+        if(S_ISDIR(st.st_mode)) {
+            list_files(child, skip, files);
+        } else if(S_ISREG(st.st_mode)) {
+            files->push_back(child);
+        }
+    }
+}
+
+static bool make_directories(const std::string& path) {
+    if(path.empty() || get_modification_time(path) != 0) {
+        return true;
+    }
+
+    const size_t pos = path.find_last_of('/');
+    if(pos != std::string::npos && pos > 0 && !make_directories(path.substr(0, pos))) {
+        return false;
+    }
+
+    // another worker may have created the directory in the meantime
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+static bool read_file(const std::string& filename, std::string* contents) {
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    if(!f.is_open()) {
+        return false;
+    }
+
+    contents->assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static uint64_t fnv1a(const std::string& data, uint64_t hash) {
+    for(size_t i=0; i<data.size(); i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static time_t get_modification_time(const std::string& filename) {
+    struct stat st;
+    if(stat(filename.c_str(), &st) != 0) {
+        return 0;
+    }
+
+    return st.st_mtime;
+}
@@ -0,0 +1,190 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _ASSET_COMPILER_H
+#define _ASSET_COMPILER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <boost/format.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "core/mesh.h"
+#include "core/texture_manager.h"
+
+/**
+ * @class AssetCompiler class
+ *
+ * @brief converts the asset tree into formats that load without processing
+ *
+ * Meshes are welded, clustered and simplified into binary .imesh files,
+ * textures are decoded into GPU-ready .itex files and shaders are stripped
+ * of comments and blank lines. The results are placed in a mirror of the
+ * asset tree below CACHE_DIR. A manifest stores the content hash of every
+ * source, such that only changed assets are rebuilt.
+ *
+ * At runtime the AssetManager picks up compiled assets through
+ * find_compiled; sources without an up-to-date compiled counterpart are
+ * loaded as before.
+ */
+class AssetCompiler {
+private:
+    /**
+     * @brief      conversion of a single source file
+     */
+    struct CompileJob {
+        unsigned int type;          //!< asset type (ASSET_*)
+        std::string source;         //!< path to the source file
+        std::string output;         //!< path to the compiled file
+        uint64_t hash;              //!< content hash of the source
+    };
+
+    std::string root;                                   //!< root of the asset tree
+    std::map<std::string, uint64_t> manifest;           //!< content hash by compiled file
+    std::vector<CompileJob> jobs;                       //!< conversions that need to run
+
+    std::atomic<unsigned int> next_job;                 //!< next job to be claimed by a worker
+    std::atomic<unsigned int> nr_failed;                //!< number of failed conversions
+    std::mutex output_mutex;                            //!< guards the manifest and the log
+
+public:
+    /**
+     * @brief      AssetCompiler constructor
+     *
+     * @param[in]  _root  root of the asset tree
+     */
+    AssetCompiler(const std::string& _root);
+
+    /**
+     * @brief      collect all assets that are new or have changed
+     *
+     * @param[in]  force  rebuild all assets regardless of the manifest
+     *
+     * @return     number of assets to compile
+     */
+    unsigned int scan(bool force);
+
+    /**
+     * @brief      compile the collected assets
+     *
+     * @param[in]  nr_threads  number of worker threads
+     *
+     * @return     number of assets that failed to compile
+     */
+    unsigned int compile(unsigned int nr_threads);
+
+    /**
+     * @brief      get the path of the compiled counterpart of an asset
+     *
+     * @param[in]  filename  path to the source (shaders without extension)
+     *
+     * @return     path inside CACHE_DIR, or an empty string if the asset
+     *             lies outside of the asset tree
+     */
+    static std::string get_compiled_path(const std::string& filename);
+
+    /**
+     * @brief      resolve an asset to its compiled counterpart
+     *
+     * @param[in]  filename  path to the source
+     *
+     * @return     compiled path if it is at least as new as the source and
+     *             has the current format, otherwise the source path
+     */
+    static std::string find_compiled(const std::string& filename);
+
+    /**
+     * @brief      resolve a shader to its compiled counterpart
+     *
+     * @param[in]  filename  path to the shader files (without extension)
+     *
+     * @return     compiled path (without extension) if both stages are up to
+     *             date, otherwise the source path
+     */
+    static std::string find_compiled_shader(const std::string& filename);
+
+    /**
+     * @brief      strip comments, trailing whitespace and blank lines
+     *
+     * @param[in]  source  shader source
+     *
+     * @return     preprocessed shader source
+     */
+    static std::string preprocess_shader(const std::string& source);
+
+    enum {
+        ASSET_MESH,
+        ASSET_SHADER,
+        ASSET_TEXTURE,
+
+        NUM_ASSET_TYPES
+    };
+
+    static const char* ASSET_ROOT;                      //!< directory holding the assets
+    static const char* CACHE_DIR;                       //!< directory below ASSET_ROOT holding compiled assets
+    static const uint32_t FORMAT_VERSION = 1;           //!< bump to invalidate every compiled asset
+
+private:
+    /**
+     * @brief      loop executed by every worker thread
+     */
+    void worker_loop();
+
+    /**
+     * @brief      convert a single asset
+     *
+     * @param[in]  job   conversion
+     *
+     * @return     true on success
+     */
+    bool compile_job(const CompileJob& job) const;
+
+    /**
+     * @brief      read the manifest of the previous run
+     */
+    void load_manifest();
+
+    /**
+     * @brief      write the manifest
+     */
+    void save_manifest() const;
+
+    /**
+     * @brief      get the path to the manifest
+     *
+     * @return     path
+     */
+    std::string get_manifest_path() const;
+};
+
+#endif // _ASSET_COMPILER_H
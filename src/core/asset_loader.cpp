@@ -0,0 +1,133 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "asset_loader.h"
+
+/**
+ * @brief       asset loader constructor
+ *
+ * @return      asset loader instance
+ */
+AssetLoader::AssetLoader() {
+    this->nr_pending = 0;
+    this->flag_stop = false;
+
+    // leave one core for the render thread
+    const unsigned int nr_threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    for(unsigned int i=0; i<nr_threads; i++) {
+        this->workers.push_back(std::thread(&AssetLoader::worker_loop, this));
+    }
+}
+
+/**
+ * @brief      queue an asset for loading
+ *
+ * @param[in]  load    stage executed on a worker thread (no OpenGL calls)
+ * @param[in]  upload  stage executed on the render thread
+ */
+void AssetLoader::submit(const std::function<void()>& load, const std::function<void()>& upload) {
+    this->nr_pending++;
+
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        this->jobs.push_back(std::make_pair(load, upload));
+    }
+
+    this->jobs_available.notify_one();
+}
+
+/**
+ * @brief      execute queued upload stages on the render thread
+ *
+ * @param[in]  budget  time budget in seconds
+ */
+void AssetLoader::process_uploads(double budget) {
+    const boost::chrono::high_resolution_clock::time_point start = boost::chrono::high_resolution_clock::now();
+
+    do {
+        std::function<void()> upload;
+
+        {
+            std::lock_guard<std::mutex> lock(this->uploads_mutex);
+            if(this->uploads.empty()) {
+                return;
+            }
+            upload = this->uploads.front();
+            this->uploads.pop_front();
+        }
+
+        upload();
+        this->nr_pending--;
+
+    } while(boost::chrono::duration<double>(boost::chrono::high_resolution_clock::now() - start).count() < budget);
+}
+
+/**
+ * @brief      block until every submitted asset is uploaded
+ */
+void AssetLoader::finish() {
+    while(this->nr_pending > 0) {
+        this->process_uploads();
+        std::this_thread::yield();
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        this->flag_stop = true;
+    }
+
+    this->jobs_available.notify_all();
+    for(unsigned int i=0; i<this->workers.size(); i++) {
+        this->workers[i].join();
+    }
+}
+
+/**
+ * @brief      loop executed by every worker thread
+ */
+void AssetLoader::worker_loop() {
+    while(true) {
+        std::pair<std::function<void()>, std::function<void()> > job;
+
+        {
+            std::unique_lock<std::mutex> lock(this->jobs_mutex);
+            while(this->jobs.empty() && !this->flag_stop) {
+                this->jobs_available.wait(lock);
+            }
+
+            if(this->flag_stop) {
+                return;
+            }
+
+            job = this->jobs.front();
+            this->jobs.pop_front();
+        }
+
+        // parse and decode
+        job.first();
+
+        // hand the OpenGL part over to the render thread
+        std::lock_guard<std::mutex> lock(this->uploads_mutex);
+        this->uploads.push_back(job.second);
+    }
+}
@@ -0,0 +1,127 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _ASSET_LOADER_H
+#define _ASSET_LOADER_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <boost/chrono.hpp>
+
+/**
+ * @class AssetLoader class
+ *
+ * @brief loads assets asynchronously
+ *
+ * Every asset is loaded in two stages. The first stage (reading, parsing and
+ * decoding) runs on a pool of worker threads. Once finished, the second
+ * stage (creating the OpenGL objects) is queued for the render thread, which
+ * processes the queue at the start of every frame under a time budget.
+ */
+class AssetLoader {
+private:
+    std::vector<std::thread> workers;                   //!< worker threads
+
+    std::deque<std::pair<std::function<void()>, std::function<void()> > > jobs;   //!< pending CPU stages with their upload stage
+    std::deque<std::function<void()> > uploads;         //!< upload stages ready for the render thread
+
+    std::mutex jobs_mutex;                              //!< guards jobs and flag_stop
+    std::mutex uploads_mutex;                           //!< guards uploads
+    std::condition_variable jobs_available;             //!< signals workers that jobs are available
+
+    std::atomic<unsigned int> nr_pending;               //!< number of assets that are not yet uploaded
+    bool flag_stop;                                     //!< whether the workers should terminate
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the asset loader
+     *
+     * @return      reference to the asset loader object (singleton pattern)
+     */
+    static AssetLoader& get() {
+        static AssetLoader asset_loader_instance;
+        return asset_loader_instance;
+    }
+
+    /**
+     * @brief      queue an asset for loading
+     *
+     * @param[in]  load    stage executed on a worker thread (no OpenGL calls)
+     * @param[in]  upload  stage executed on the render thread
+     */
+    void submit(const std::function<void()>& load, const std::function<void()>& upload);
+
+    /**
+     * @brief      execute queued upload stages on the render thread
+     *
+     *             At least one upload is processed per call, such that
+     *             loading always progresses.
+     *
+     * @param[in]  budget  time budget in seconds
+     */
+    void process_uploads(double budget = DEFAULT_UPLOAD_BUDGET);
+
+    /**
+     * @brief      block until every submitted asset is uploaded
+     *
+     *             Needs to be called from the render thread.
+     */
+    void finish();
+
+    /**
+     * @brief      get the number of assets that are not yet uploaded
+     *
+     * @return     number of pending assets
+     */
+    inline unsigned int get_nr_pending() const {
+        return this->nr_pending;
+    }
+
+    static constexpr double DEFAULT_UPLOAD_BUDGET = 0.004;     //!< seconds per frame spent on uploads
+
+    ~AssetLoader();
+
+private:
+    /**
+     * @brief       asset loader constructor
+     *
+     * @return      asset loader instance
+     */
+    AssetLoader();
+
+    /**
+     * @brief      loop executed by every worker thread
+     */
+    void worker_loop();
+
+    AssetLoader(AssetLoader const&)          = delete;
+    void operator=(AssetLoader const&)  = delete;
+};
+
+#endif // _ASSET_LOADER_H
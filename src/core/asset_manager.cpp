@@ -0,0 +1,297 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "asset_manager.h"
+#include "core/render_queue.h"
+
+// resolve symlinks, relative components and duplicate separators
+static std::string canonical_path(const std::string& filename);
+
+/**
+ * @brief       asset manager constructor
+ *
+ * @return      asset manager instance
+ */
+AssetManager::AssetManager() {
+    Console::get() << std::string(__FILE__) << ": Starting AssetManager class" << Console::endl;
+}
+
+/**
+ * @brief      acquire a mesh; the mesh is loaded asynchronously on first use
+ *
+ * @param[in]  filename     path to the mesh file
+ * @param[in]  compression  compact vertex formats (see Mesh::set_vertex_compression)
+ *
+ * @return     pointer to the shared mesh
+ */
+Mesh* AssetManager::acquire_mesh(const std::string& filename, unsigned int compression, unsigned int retention) {
+    const std::string variant = boost::lexical_cast<std::string>(compression);
+    const AssetIterator it = this->assets.insert(std::make_pair(this->make_key(ASSET_MESH, filename, variant), AssetEntry())).first;
+    AssetEntry& entry = it->second;
+
+    if(entry.ref_count++ == 0 && entry.mesh == NULL) {
+        entry.type = ASSET_MESH;
+        entry.path = canonical_path(filename);
+        entry.variant = variant;
+        entry.mesh = new Mesh();
+        entry.retention = retention;
+        this->mesh_index[entry.mesh] = it;
+
+        // parse on a worker thread, upload on the render thread; compiled meshes skip the parsing
+        Mesh* mesh = entry.mesh;
+        const std::string path = canonical_path(AssetCompiler::find_compiled(filename));
+        const std::string source = entry.path;
+        // entries outlive their pending upload (see collect), and both run on the render thread
+        AssetEntry* owner = &entry;
+        AssetLoader::get().submit(
+            [mesh, path, source]() {
+                // a compiled mesh that cannot be read is loaded from its source instead
+                if(!mesh->load_mesh_from_file(path) && path != source) {
+                    mesh->load_mesh_from_file(source);
+                }
+            },
+            [mesh, path, compression, owner]() {
+                // a mesh that failed to load stays unloaded, such that its users never activate
+                if(mesh->is_failed()) {
+                    Console::get() << std::string(__FILE__) + ": Failed to load mesh: " << path << Console::endl;
+                    owner->failed = true;
+                    return;
+                }
+                Console::get() << std::string(__FILE__) + ": Loading mesh: " << path << Console::endl;
+                mesh->set_vertex_compression(compression);
+                mesh->set_cpu_retention(owner->retention);
+                mesh->static_load();
+            });
+    } else {
+        entry.retention |= retention;
+    }
+
+    return entry.mesh;
+}
+
+/**
+ * @brief      acquire a shader program
+ *
+ * @param[in]  filename  path to the shader files (without extension)
+ *
+ * @return     pointer to the shared shader
+ */
+Shader* AssetManager::acquire_shader(const std::string& filename) {
+    const AssetIterator it = this->assets.insert(std::make_pair(this->make_key(ASSET_SHADER, filename, ""), AssetEntry())).first;
+    AssetEntry& entry = it->second;
+
+    if(entry.ref_count++ == 0 && entry.shader == NULL) {
+        entry.type = ASSET_SHADER;
+        entry.path = canonical_path(filename + ".vs");
+        entry.path = entry.path.substr(0, entry.path.size() - 3);
+        entry.shader = new Shader(AssetCompiler::find_compiled_shader(entry.path));
+        this->shader_index[entry.shader] = it;
+    }
+
+    return entry.shader;
+}
+
+/**
+ * @brief      acquire a texture; the texture is loaded asynchronously on first use
+ *
+ * @param[in]  filename  path to the image file
+ *
+ * @return     texture id (see TextureManager)
+ */
+unsigned int AssetManager::acquire_texture(const std::string& filename) {
+    const std::string key = this->make_key(ASSET_TEXTURE, filename, "");
+    AssetIterator it = this->assets.find(key);
+
+    if(it == this->assets.end()) {
+        AssetEntry entry;
+        entry.type = ASSET_TEXTURE;
+        entry.path = canonical_path(filename);
+        const std::string path = canonical_path(AssetCompiler::find_compiled(filename));
+        entry.texture_id = TextureManager::get().load_texture_async(path, (path != entry.path) ? entry.path : "");
+        it = this->assets.insert(std::make_pair(key, entry)).first;
+        this->texture_index[entry.texture_id] = it;
+    }
+
+    it->second.ref_count++;
+
+    return it->second.texture_id;
+}
+
+/**
+ * @brief      release a mesh
+ *
+ * @param[in]  mesh  pointer to the mesh
+ */
+void AssetManager::release_mesh(const Mesh* mesh) {
+    std::map<const Mesh*, AssetIterator>::iterator it = this->mesh_index.find(mesh);
+    if(it != this->mesh_index.end()) {
+        this->release(it->second);
+    }
+}
+
+/**
+ * @brief      release a shader
+ *
+ * @param[in]  shader  pointer to the shader
+ */
+void AssetManager::release_shader(const Shader* shader) {
+    std::map<const Shader*, AssetIterator>::iterator it = this->shader_index.find(shader);
+    if(it != this->shader_index.end()) {
+        this->release(it->second);
+    }
+}
+
+/**
+ * @brief      release a texture
+ *
+ * @param[in]  texture_id  texture id
+ */
+void AssetManager::release_texture(unsigned int texture_id) {
+    std::map<unsigned int, AssetIterator>::iterator it = this->texture_index.find(texture_id);
+    if(it != this->texture_index.end()) {
+        this->release(it->second);
+    }
+}
+
+/**
+ * @brief      free all assets that have no users and have finished loading
+ */
+void AssetManager::collect() {
+    AssetIterator it = this->assets.begin();
+    while(it != this->assets.end()) {
+        AssetEntry& entry = it->second;
+
+        if(entry.ref_count > 0) {
+            ++it;
+            continue;
+        }
+
+        // assets that are still in flight are freed once they are uploaded (or have failed)
+        switch(entry.type) {
+            case ASSET_MESH:
+                if(!entry.mesh->is_loaded() && !entry.failed) {
+                    ++it;
+                    continue;
+                }
+                this->mesh_index.erase(entry.mesh);
+                RenderQueue::get().release(entry.mesh);
+                delete entry.mesh;
+            break;
+            case ASSET_SHADER:
+                this->shader_index.erase(entry.shader);
+                RenderQueue::get().release(entry.shader);
+                delete entry.shader;
+            break;
+            case ASSET_TEXTURE:
+                if(!TextureManager::get().is_loaded(entry.texture_id) && !TextureManager::get().is_failed(entry.texture_id)) {
+                    ++it;
+                    continue;
+                }
+                this->texture_index.erase(entry.texture_id);
+                TextureManager::get().unload_texture(entry.texture_id);
+            break;
+            default:
+                // do nothing
+            break;
+        }
+
+        this->assets.erase(it++);
+    }
+}
+
+/**
+ * @brief      describe the resident assets
+ *
+ * @return     one line per asset with its users and memory footprint
+ */
+std::vector<std::string> AssetManager::report() const {
+    static const char* type_names[] = {"mesh", "shader", "texture"};
+
+    std::vector<std::string> lines;
+
+    for(std::map<std::string, AssetEntry>::const_iterator it = this->assets.begin(); it != this->assets.end(); ++it) {
+        const AssetEntry& entry = it->second;
+
+        size_t cpu_bytes = 0;
+        size_t gpu_bytes = 0;
+        bool loaded = true;
+        bool failed = entry.failed;
+        switch(entry.type) {
+            case ASSET_MESH:
+                cpu_bytes = entry.mesh->get_cpu_memory();
+                gpu_bytes = entry.mesh->get_gpu_memory();
+                loaded = entry.mesh->is_loaded();
+            break;
+            case ASSET_TEXTURE:
+                gpu_bytes = TextureManager::get().get_memory(entry.texture_id);
+                loaded = TextureManager::get().is_loaded(entry.texture_id);
+                failed = TextureManager::get().is_failed(entry.texture_id);
+            break;
+            default:
+                // shader programs live in the driver; their size is unknown
+            break;
+        }
+
+        lines.push_back((boost::format("%-7s %3u refs %8.1f KiB cpu %8.1f KiB gpu %s %s") % type_names[entry.type] % entry.ref_count
+                         % (cpu_bytes / 1024.0) % (gpu_bytes / 1024.0) % (loaded ? "  " : (failed ? "!!" : "..")) % entry.path).str());
+    }
+
+    lines.push_back((boost::format("%u assets; all meshes: %.1f KiB cpu, %.1f KiB gpu") % this->assets.size()
+                     % (Mesh::get_total_cpu_memory() / 1024.0) % (Mesh::get_total_gpu_memory() / 1024.0)).str());
+
+    return lines;
+}
+
+/**
+ * @brief      build the registry key of an asset
+ *
+ * @param[in]  type      asset type
+ * @param[in]  filename  path to the asset
+ * @param[in]  variant   variant of the asset
+ *
+ * @return     key
+ */
+std::string AssetManager::make_key(unsigned int type, const std::string& filename, const std::string& variant) const {
+    const std::string path = (type == ASSET_SHADER) ? canonical_path(filename + ".vs") : canonical_path(filename);
+    return boost::lexical_cast<std::string>(type) + ":" + path + "#" + variant;
+}
+
+/**
+ * @brief      decrement the reference count of an entry
+ *
+ * @param[in]  it    iterator to the entry
+ */
+void AssetManager::release(AssetIterator it) {
+    if(it->second.ref_count > 0) {
+        it->second.ref_count--;
+    }
+}
+
+static std::string canonical_path(const std::string& filename) {
+    char buffer[PATH_MAX];
+
+    // fall back to the path as given for files that do not exist
+    if(realpath(filename.c_str(), buffer) == NULL) {
+        return filename;
+    }
+
+    return std::string(buffer);
+}
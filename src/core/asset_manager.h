@@ -0,0 +1,198 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _ASSET_MANAGER_H
+#define _ASSET_MANAGER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <climits>
+#include <stdlib.h>
+
+#include <boost/format.hpp>
+
+#include "core/asset_compiler.h"
+#include "core/asset_loader.h"
+#include "core/mesh.h"
+#include "core/shader.h"
+#include "core/texture_manager.h"
+
+/**
+ * @class AssetManager class
+ *
+ * @brief registry of all meshes, shaders and textures
+ *
+ * Assets are keyed by their canonical path and a variant (e.g. the vertex
+ * compression of a mesh), such that every asset is loaded only once and
+ * shared among its users. Every acquire needs to be matched by a release;
+ * assets without users are freed by collect(). Assets that have been
+ * compiled by isana-assetc are loaded from their compiled counterpart.
+ */
+class AssetManager {
+private:
+    /**
+     * @brief      bookkeeping of a single asset
+     */
+    struct AssetEntry {
+        unsigned int type;          //!< asset type (ASSET_*)
+        std::string path;           //!< canonical path
+        std::string variant;        //!< variant of the asset
+        Mesh* mesh;                 //!< mesh (if type is ASSET_MESH)
+        Shader* shader;             //!< shader (if type is ASSET_SHADER)
+        unsigned int texture_id;    //!< texture id (if type is ASSET_TEXTURE)
+        unsigned int retention;     //!< requested mesh retention (read at upload)
+        unsigned int ref_count;     //!< number of users
+        bool failed;                //!< whether the asset could not be loaded (set on the render thread)
+
+        AssetEntry() :
+            type(0),
+            mesh(NULL),
+            shader(NULL),
+            texture_id(0),
+            retention(0),
+            ref_count(0),
+            failed(false) {}
+    };
+
+    typedef std::map<std::string, AssetEntry>::iterator AssetIterator;
+
+    std::map<std::string, AssetEntry> assets;               //!< assets by key
+    std::map<const Mesh*, AssetIterator> mesh_index;        //!< entries of the meshes
+    std::map<const Shader*, AssetIterator> shader_index;    //!< entries of the shaders
+    std::map<unsigned int, AssetIterator> texture_index;    //!< entries of the textures
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the asset manager
+     *
+     * @return      reference to the asset manager object (singleton pattern)
+     */
+    static AssetManager& get() {
+        static AssetManager asset_manager_instance;
+        return asset_manager_instance;
+    }
+
+    /**
+     * @brief      acquire a mesh; the mesh is loaded asynchronously on first use
+     *
+     * @param[in]  filename     path to the mesh file
+     * @param[in]  compression  compact vertex formats (see Mesh::set_vertex_compression)
+     * @param[in]  retention    CPU-side data kept after upload (see Mesh::set_cpu_retention);
+     *                          users of a shared mesh get the union of their requests
+     *                          as long as the mesh has not been uploaded
+     *
+     * @return     pointer to the shared mesh
+     */
+    Mesh* acquire_mesh(const std::string& filename, unsigned int compression, unsigned int retention = Mesh::RETAIN_ALL);
+
+    /**
+     * @brief      acquire a shader program
+     *
+     * @param[in]  filename  path to the shader files (without extension)
+     *
+     * @return     pointer to the shared shader
+     */
+    Shader* acquire_shader(const std::string& filename);
+
+    /**
+     * @brief      acquire a texture; the texture is loaded asynchronously on first use
+     *
+     * @param[in]  filename  path to the image file
+     *
+     * @return     texture id (see TextureManager)
+     */
+    unsigned int acquire_texture(const std::string& filename);
+
+    /**
+     * @brief      release a mesh
+     *
+     * @param[in]  mesh  pointer to the mesh
+     */
+    void release_mesh(const Mesh* mesh);
+
+    /**
+     * @brief      release a shader
+     *
+     * @param[in]  shader  pointer to the shader
+     */
+    void release_shader(const Shader* shader);
+
+    /**
+     * @brief      release a texture
+     *
+     * @param[in]  texture_id  texture id
+     */
+    void release_texture(unsigned int texture_id);
+
+    /**
+     * @brief      free all assets that have no users and have finished loading
+     */
+    void collect();
+
+    /**
+     * @brief      describe the resident assets
+     *
+     * @return     one line per asset with its users and memory footprint
+     */
+    std::vector<std::string> report() const;
+
+    enum {
+        ASSET_MESH,
+        ASSET_SHADER,
+        ASSET_TEXTURE,
+
+        NUM_ASSET_TYPES
+    };
+
+private:
+    /**
+     * @brief       asset manager constructor
+     *
+     * @return      asset manager instance
+     */
+    AssetManager();
+
+    /**
+     * @brief      build the registry key of an asset
+     *
+     * @param[in]  type      asset type
+     * @param[in]  filename  path to the asset
+     * @param[in]  variant   variant of the asset
+     *
+     * @return     key
+     */
+    std::string make_key(unsigned int type, const std::string& filename, const std::string& variant) const;
+
+    /**
+     * @brief      decrement the reference count of an entry
+     *
+     * @param[in]  it    iterator to the entry
+     */
+    void release(AssetIterator it);
+
+    AssetManager(AssetManager const&)          = delete;
+    void operator=(AssetManager const&)  = delete;
+};
+
+#endif // _ASSET_MANAGER_H
@@ -37,13 +37,11 @@ void Camera::update() {
 glm::mat4 Camera::get_view() {
     this->calculate_position();
 
-    this->view = glm::lookAt(
-                    this->position,              // cam pos
-                    this->look_at,               // look at
-                    glm::vec3(0.0f, 0.0f, 1.0f)  // up
-                );
-
-    return view;
+    return glm::lookAt(
+                this->position,              // cam pos
+                this->look_at,               // look at
+                glm::vec3(0.0f, 0.0f, 1.0f)  // up
+            );
 }
 
 /**
@@ -159,6 +157,5 @@ Camera::Camera() {
     this->calculate_position();
 
     this->m_aspect = 1.0f;
-    this->view = glm::mat4(1.0f);
     this->projection = glm::mat4(1.0f);
 }
@@ -172,7 +172,6 @@ private:
     Camera();
 
     glm::mat4 projection;   //!< perspective matrix
-    glm::mat4 view;         //!< view matrix
 
     float distance;         //!< distance of the camera with respect to looking position
     float theta;            //!< rotation angle
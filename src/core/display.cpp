@@ -85,12 +85,12 @@ Display::Display() {
     }
 
     // enable transparency
-    glEnable (GL_BLEND);
-    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::get().enable(GL_BLEND);
+    GLState::get().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // enable culling
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_DEPTH_TEST);
+    GLState::get().enable(GL_CULL_FACE);
+    GLState::get().enable(GL_DEPTH_TEST);
 
     // disable cursor (we are going to use our own)
     //glfwSetInputMode(this->m_window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
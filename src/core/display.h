@@ -29,6 +29,7 @@
 #include <boost/format.hpp>
 
 #include "core/camera.h"
+#include "core/gl_state.h"
 #include "core/visualizer.h"
 #include "core/screen.h"
 
@@ -29,6 +29,7 @@ FontWriter::FontWriter() {
     this->base_font_size = 32;
     this->display_charmap = false;
     this->is_cached = false;
+    this->load_record = LoadStatistics::get().add_record("font", FONT_FILE);
 
     if(FT_Init_FreeType(&this->library)) {
         std::cerr << "FT_Init_FreeType failed" << std::endl;
@@ -46,9 +47,9 @@ FontWriter::FontWriter() {
     this->shader->set_texture_id(1); // corresponds to GL_TEXTURE1
 
     glGenVertexArrays(1, &this->m_vertex_array_object);
-    glBindVertexArray(this->m_vertex_array_object);
+    GLState::get().bind_vertex_array(this->m_vertex_array_object);
     this->shader->bind_uniforms_and_attributes();
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
 
     FT_Done_FreeType(this->library);
 }
@@ -84,8 +85,7 @@ void FontWriter::draw() {
 
     this->static_load();
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
+    GLState::get().bind_texture(1, GL_TEXTURE_2D, this->texture);
 
     this->shader->link_shader();
     this->shader->set_uniform(0, &projection[0][0]);
@@ -93,15 +93,10 @@ void FontWriter::draw() {
     this->shader->set_uniform(2, NULL);
 
     // load the vertex array
-    glBindVertexArray(m_vertex_array_object);
+    GLState::get().bind_vertex_array(m_vertex_array_object);
 
     // draw the mesh using the indices
     glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, 0);
-
-    // after this command, any commands that use a vertex array will
-    // no longer work
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void FontWriter::render_line(float x, float y, const std::string& line) {
@@ -147,7 +142,7 @@ void FontWriter::static_load() {
     unsigned int size = this->indices.size();
 
     // generate a vertex array object and store it in the pointer
-    glBindVertexArray(this->m_vertex_array_object);
+    GLState::get().bind_vertex_array(this->m_vertex_array_object);
 
     // generate a number of buffers (blocks of data on the GPU)
     glGenBuffers(3, this->m_vertex_array_buffers);
@@ -189,10 +184,6 @@ void FontWriter::static_load() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vertex_array_buffers[2]);
     // fill the buffer with data
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, size * sizeof(unsigned int), &this->indices[0], GL_STATIC_DRAW);
-
-    // after this command, any commands that use a vertex array will
-    // no longer work
-    glBindVertexArray(0);
 }
 
 void FontWriter::add_charmap_to_screen() {
@@ -235,19 +226,29 @@ void FontWriter::generate_character_map() {
     unsigned int temp_y = 0;
     unsigned int counter = 0;           // iteration counter
 
+    // read the font once; every glyph is rendered from memory
+    std::vector<FT_Byte> font_data;
+    {
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_READ);
+        std::ifstream f(FONT_FILE, std::ios::binary);
+        font_data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+    LoadStatistics::get().add_bytes_read(this->load_record, font_data.size());
+
+    LoadTimer timer(this->load_record, LoadStatistics::PHASE_PARSE);
+
+    FT_Face face;
+    if(font_data.empty() || FT_New_Memory_Face(this->library, &font_data[0], font_data.size(), 0, &face)) {
+        std::cerr << "FT_New_Face failed (there is probably a problem with your font file)" << std::endl;
+    }
+
+    FT_Set_Char_Size( face, base_font_size * 64, base_font_size * 64, 128, 128);
+
     // collect all data of the glyphs and store them in temporary vectors
     for(unsigned int i=32; i<=126; i++) {
         counter++;
         char c = (char)i;
 
-        FT_Face face;
-
-        if(FT_New_Face( this->library, "./assets/fonts/sourcecodepro-regular.ttf", 0, &face )) {
-            std::cerr << "FT_New_Face failed (there is probably a problem with your font file)" << std::endl;
-        }
-
-        FT_Set_Char_Size( face, base_font_size * 64, base_font_size * 64, 128, 128);
-
         if(FT_Load_Char(face, c, FT_LOAD_RENDER | FT_LOAD_TARGET_MONO)) {
             std::cerr << "Error loading char." << std::endl;
         }
@@ -263,8 +264,6 @@ void FontWriter::generate_character_map() {
 
         char_bitmaps[i] = this->unpack_mono_bitmap(face->glyph->bitmap);
 
-        FT_Done_Face(face);
-
         temp_x += width;
         temp_y = std::max(temp_y, height);
 
@@ -283,6 +282,9 @@ void FontWriter::generate_character_map() {
         img_height += temp_y;
     }
 
+    FT_Done_Face(face);
+    timer.next_phase(LoadStatistics::PHASE_PROCESS);
+
     // store char map sizes
     this->texture_width = img_width;
     this->texture_height = img_height;
@@ -330,10 +332,11 @@ void FontWriter::generate_character_map() {
         }
     }
 
+    timer.next_phase(LoadStatistics::PHASE_UPLOAD);
+
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glActiveTexture(GL_TEXTURE1);
     glGenTextures(1, &this->texture);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
+    GLState::get().bind_texture(1, GL_TEXTURE_2D, this->texture);
     glTexImage2D(
         GL_TEXTURE_2D,
         0,
@@ -349,7 +352,9 @@ void FontWriter::generate_character_map() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(1, GL_TEXTURE_2D, 0);
+
+    LoadStatistics::get().set_memory(this->load_record, this->glyphs.size() * sizeof(Glyph), expanded_data.size());
 }
 
 std::vector<bool> FontWriter::unpack_mono_bitmap(FT_Bitmap bitmap) {
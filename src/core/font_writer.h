@@ -35,6 +35,7 @@
 
 #include "shader.h"
 #include "screen.h"
+#include "load_statistics.h"
 
 /**
  * @class FontWriter
@@ -47,6 +48,7 @@ private:
     FT_Library library;         //!< FreeType library
 
     const unsigned int font_padding = 10;
+    const char* FONT_FILE = "./assets/fonts/sourcecodepro-regular.ttf";    //!< font used for all text
 
     /**
      * @struct Glyph
@@ -115,6 +117,8 @@ private:
     bool display_charmap;                           //!< flag whether to print charmap to screen
     bool is_cached;                                 //!< whether current lines are cached in memory
 
+    unsigned int load_record;                       //!< record in LoadStatistics
+
 public:
     /**
      * @brief       get a reference to the FontWriter
@@ -0,0 +1,63 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "frame_constants.h"
+
+const char* const FrameConstants::BLOCK_NAME = "FrameConstants";
+
+/**
+ * @brief       frame constants constructor
+ *
+ * @return      frame constants instance
+ */
+FrameConstants::FrameConstants() {
+    this->block = FrameConstantsBlock();
+    this->block.time = 0.0f;
+
+    glGenBuffers(1, &this->buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, this->buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstantsBlock), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, this->buffer);
+}
+
+/**
+ * @brief      compute the constants of a new frame and upload them
+ *
+ * @param[in]  time  time since the start of the program in seconds
+ */
+void FrameConstants::update(double time) {
+    this->block.view = Camera::get().get_view();
+    this->block.projection = Camera::get().get_projection();
+    this->block.view_projection = this->block.projection * this->block.view;
+    this->block.camera_position = glm::vec4(Camera::get().get_position(), 1.0f);
+    this->block.ambient_light = Sky::get().get_sky_color();
+    this->block.time = (float)time;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, this->buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstantsBlock), &this->block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+FrameConstants::~FrameConstants() {
+    glDeleteBuffers(1, &this->buffer);
+}
@@ -0,0 +1,121 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _FRAME_CONSTANTS_H
+#define _FRAME_CONSTANTS_H
+
+#include <GL/glew.h>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "core/camera.h"
+#include "environment/sky.h"
+
+/**
+ * @brief      contents of the FrameConstants uniform block
+ *
+ * Follows the std140 layout of the block in assets/shaders/frame_constants.glsl:
+ * matrices and vectors are aligned to 16 bytes, and the block is padded to a
+ * multiple of 16 bytes.
+ */
+struct FrameConstantsBlock {
+    glm::mat4 view;             //!< view matrix
+    glm::mat4 projection;       //!< projection matrix
+    glm::mat4 view_projection;  //!< projection times view matrix
+    glm::vec4 camera_position;  //!< camera position (w is one)
+    glm::vec4 ambient_light;    //!< colour of the sky
+    float time;                 //!< time since the start of the program in seconds
+    float padding[3];           //!< round up to a multiple of 16 bytes
+};
+
+/**
+ * @class FrameConstants class
+ *
+ * @brief uniform buffer holding the camera, lighting and time of a frame
+ *
+ * The values are computed once per frame and bound to BINDING_POINT, which
+ * every shader with a FrameConstants block reads from (see Shader). Objects
+ * then only set their own uniforms per draw.
+ */
+class FrameConstants {
+private:
+    GLuint buffer;                  //!< OpenGL reference to the uniform buffer
+    FrameConstantsBlock block;      //!< values of the current frame
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the frame constants
+     *
+     * @return      reference to the frame constants object (singleton pattern)
+     */
+    static FrameConstants& get() {
+        static FrameConstants frame_constants_instance;
+        return frame_constants_instance;
+    }
+
+    /**
+     * @brief      compute the constants of a new frame and upload them
+     *
+     *             Requires the camera to be updated (see Camera::update).
+     *             The view is only computed here; everything else reads it
+     *             from the frame constants.
+     *
+     * @param[in]  time  time since the start of the program in seconds
+     */
+    void update(double time);
+
+    inline const glm::mat4& get_view() const {
+        return this->block.view;
+    }
+
+    inline const glm::mat4& get_projection() const {
+        return this->block.projection;
+    }
+
+    inline const glm::mat4& get_view_projection() const {
+        return this->block.view_projection;
+    }
+
+    inline glm::vec3 get_camera_position() const {
+        return glm::vec3(this->block.camera_position);
+    }
+
+    ~FrameConstants();
+
+    static const GLuint BINDING_POINT = 0;      //!< uniform buffer binding point of the block
+    static const char* const BLOCK_NAME;        //!< name of the uniform block in the shaders
+
+private:
+    /**
+     * @brief       frame constants constructor
+     *
+     * @return      frame constants instance
+     */
+    FrameConstants();
+
+    FrameConstants(FrameConstants const&)          = delete;
+    void operator=(FrameConstants const&)  = delete;
+};
+
+#endif // _FRAME_CONSTANTS_H
@@ -0,0 +1,64 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "frustum.h"
+
+/**
+ * @brief      Frustum constructor
+ *
+ * @param[in]  m     (model-)view-projection matrix
+ */
+Frustum::Frustum(const glm::mat4& m) {
+    // rows of the (column-major) matrix
+    const glm::vec4 r0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 r1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 r2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 r3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    this->planes[0] = r3 + r0;  // left
+    this->planes[1] = r3 - r0;  // right
+    this->planes[2] = r3 + r1;  // bottom
+    this->planes[3] = r3 - r1;  // top
+    this->planes[4] = r3 + r2;  // near
+    this->planes[5] = r3 - r2;  // far
+
+    for(unsigned int i=0; i<6; i++) {
+        this->planes[i] /= glm::length(glm::vec3(this->planes[i]));
+    }
+}
+
+/**
+ * @brief      test whether a sphere intersects the frustum
+ *
+ * @param[in]  center  center of the sphere
+ * @param[in]  radius  radius of the sphere
+ *
+ * @return     false if the sphere is completely outside
+ */
+bool Frustum::intersects_sphere(const glm::vec3& center, float radius) const {
+    for(unsigned int i=0; i<6; i++) {
+        if(glm::dot(glm::vec3(this->planes[i]), center) + this->planes[i].w < -radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
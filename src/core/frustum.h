@@ -0,0 +1,58 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _FRUSTUM_H
+#define _FRUSTUM_H
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+/**
+ * @brief      view frustum described by six planes
+ *
+ *             When constructed from a model-view-projection matrix, the
+ *             planes live in model space, such that bounding volumes of a
+ *             mesh can be tested without transforming them.
+ */
+class Frustum {
+private:
+    glm::vec4 planes[6];        //!< planes (normal, distance) with normals pointing inwards
+
+public:
+    /**
+     * @brief      Frustum constructor
+     *
+     * @param[in]  m     (model-)view-projection matrix
+     */
+    Frustum(const glm::mat4& m);
+
+    /**
+     * @brief      test whether a sphere intersects the frustum
+     *
+     * @param[in]  center  center of the sphere
+     * @param[in]  radius  radius of the sphere
+     *
+     * @return     false if the sphere is completely outside
+     */
+    bool intersects_sphere(const glm::vec3& center, float radius) const;
+};
+
+#endif //_FRUSTUM_H
@@ -0,0 +1,309 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "gl_state.h"
+
+/**
+ * @brief       state cache constructor
+ *
+ * @return      state cache instance
+ */
+GLState::GLState() {
+    this->program = UNKNOWN;
+    this->vertex_array = UNKNOWN;
+    this->read_framebuffer = UNKNOWN;
+    this->draw_framebuffer = UNKNOWN;
+    this->active_unit = UNKNOWN;
+    for(unsigned int i=0; i<MAX_UNITS; i++) {
+        for(unsigned int j=0; j<NR_TARGETS; j++) {
+            this->textures[i][j] = UNKNOWN;
+        }
+    }
+    for(unsigned int i=0; i<NR_CAPABILITIES; i++) {
+        this->capabilities[i] = UNKNOWN;
+    }
+    this->blend_src = UNKNOWN;
+    this->blend_dst = UNKNOWN;
+
+    this->nr_calls = 0;
+    this->nr_avoided = 0;
+    this->nr_calls_last_frame = 0;
+    this->nr_avoided_last_frame = 0;
+}
+
+/**
+ * @brief      glUseProgram
+ *
+ * @param[in]  _program  program
+ */
+void GLState::use_program(GLuint _program) {
+    if(this->program == _program) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glUseProgram(_program);
+    this->program = _program;
+    this->nr_calls++;
+}
+
+/**
+ * @brief      glBindVertexArray
+ *
+ * @param[in]  _vertex_array  vertex array
+ */
+void GLState::bind_vertex_array(GLuint _vertex_array) {
+    if(this->vertex_array == _vertex_array) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glBindVertexArray(_vertex_array);
+    this->vertex_array = _vertex_array;
+    this->nr_calls++;
+}
+
+/**
+ * @brief      glBindFramebuffer
+ *
+ * @param[in]  target        GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+ * @param[in]  framebuffer   framebuffer
+ */
+void GLState::bind_framebuffer(GLenum target, GLuint framebuffer) {
+    const bool read = (target != GL_DRAW_FRAMEBUFFER);
+    const bool draw = (target != GL_READ_FRAMEBUFFER);
+
+    if((!read || this->read_framebuffer == framebuffer) && (!draw || this->draw_framebuffer == framebuffer)) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glBindFramebuffer(target, framebuffer);
+    if(read) {
+        this->read_framebuffer = framebuffer;
+    }
+    if(draw) {
+        this->draw_framebuffer = framebuffer;
+    }
+    this->nr_calls++;
+}
+
+/**
+ * @brief      glActiveTexture and glBindTexture
+ *
+ * @param[in]  unit     texture unit (0 for GL_TEXTURE0)
+ * @param[in]  target   GL_TEXTURE_2D, GL_TEXTURE_2D_MULTISAMPLE or GL_TEXTURE_BUFFER
+ * @param[in]  texture  texture
+ */
+void GLState::bind_texture(GLuint unit, GLenum target, GLuint texture) {
+    this->set_active_unit(unit);
+
+    const unsigned int idx = get_target_index(target);
+    const bool tracked = (unit < MAX_UNITS && idx < NR_TARGETS);
+
+    if(tracked && this->textures[unit][idx] == texture) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glBindTexture(target, texture);
+    if(tracked) {
+        this->textures[unit][idx] = texture;
+    }
+    this->nr_calls++;
+}
+
+/**
+ * @brief      glEnable
+ *
+ * @param[in]  capability  GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST or GL_MULTISAMPLE
+ */
+void GLState::enable(GLenum capability) {
+    const unsigned int idx = get_capability_index(capability);
+
+    if(idx < NR_CAPABILITIES && this->capabilities[idx] == 1) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glEnable(capability);
+    if(idx < NR_CAPABILITIES) {
+        this->capabilities[idx] = 1;
+    }
+    this->nr_calls++;
+}
+
+/**
+ * @brief      glDisable
+ *
+ * @param[in]  capability  GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST or GL_MULTISAMPLE
+ */
+void GLState::disable(GLenum capability) {
+    const unsigned int idx = get_capability_index(capability);
+
+    if(idx < NR_CAPABILITIES && this->capabilities[idx] == 0) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glDisable(capability);
+    if(idx < NR_CAPABILITIES) {
+        this->capabilities[idx] = 0;
+    }
+    this->nr_calls++;
+}
+
+/**
+ * @brief      glBlendFunc
+ *
+ * @param[in]  src   source factor
+ * @param[in]  dst   destination factor
+ */
+void GLState::blend_func(GLenum src, GLenum dst) {
+    if(this->blend_src == src && this->blend_dst == dst) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glBlendFunc(src, dst);
+    this->blend_src = src;
+    this->blend_dst = dst;
+    this->nr_calls++;
+}
+
+/**
+ * @brief      forget a program that is about to be deleted
+ *
+ * @param[in]  _program  program
+ */
+void GLState::forget_program(GLuint _program) {
+    if(this->program == _program) {
+        this->program = UNKNOWN;
+    }
+}
+
+/**
+ * @brief      forget a vertex array that is about to be deleted
+ *
+ * @param[in]  _vertex_array  vertex array
+ */
+void GLState::forget_vertex_array(GLuint _vertex_array) {
+    if(this->vertex_array == _vertex_array) {
+        this->vertex_array = UNKNOWN;
+    }
+}
+
+/**
+ * @brief      forget a framebuffer that is about to be deleted
+ *
+ * @param[in]  framebuffer  framebuffer
+ */
+void GLState::forget_framebuffer(GLuint framebuffer) {
+    if(this->read_framebuffer == framebuffer) {
+        this->read_framebuffer = UNKNOWN;
+    }
+    if(this->draw_framebuffer == framebuffer) {
+        this->draw_framebuffer = UNKNOWN;
+    }
+}
+
+/**
+ * @brief      forget a texture that is about to be deleted
+ *
+ * @param[in]  texture  texture
+ */
+void GLState::forget_texture(GLuint texture) {
+    for(unsigned int i=0; i<MAX_UNITS; i++) {
+        for(unsigned int j=0; j<NR_TARGETS; j++) {
+            if(this->textures[i][j] == texture) {
+                this->textures[i][j] = UNKNOWN;
+            }
+        }
+    }
+}
+
+/**
+ * @brief      start counting the calls of a new frame
+ */
+void GLState::new_frame() {
+    this->nr_calls_last_frame = this->nr_calls;
+    this->nr_avoided_last_frame = this->nr_avoided;
+    this->nr_calls = 0;
+    this->nr_avoided = 0;
+}
+
+/**
+ * @brief      make a texture unit active
+ *
+ * @param[in]  unit  texture unit
+ */
+void GLState::set_active_unit(GLuint unit) {
+    if(this->active_unit == unit) {
+        this->nr_avoided++;
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    this->active_unit = unit;
+    this->nr_calls++;
+}
+
+/**
+ * @brief      get the index of a texture target
+ *
+ * @param[in]  target  texture target
+ *
+ * @return     index in the texture table (NR_TARGETS if not tracked)
+ */
+unsigned int GLState::get_target_index(GLenum target) {
+    switch(target) {
+        case GL_TEXTURE_2D:
+            return 0;
+        case GL_TEXTURE_2D_MULTISAMPLE:
+            return 1;
+        case GL_TEXTURE_BUFFER:
+            return 2;
+        default:
+            return NR_TARGETS;
+    }
+}
+
+/**
+ * @brief      get the index of a capability
+ *
+ * @param[in]  capability  capability
+ *
+ * @return     index in the capability table (NR_CAPABILITIES if not tracked)
+ */
+unsigned int GLState::get_capability_index(GLenum capability) {
+    switch(capability) {
+        case GL_BLEND:
+            return 0;
+        case GL_CULL_FACE:
+            return 1;
+        case GL_DEPTH_TEST:
+            return 2;
+        case GL_MULTISAMPLE:
+            return 3;
+        default:
+            return NR_CAPABILITIES;
+    }
+}
@@ -0,0 +1,223 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _GL_STATE_H
+#define _GL_STATE_H
+
+#include <GL/glew.h>
+
+/**
+ * @class GLState class
+ *
+ * @brief keeps track of the OpenGL state and skips calls that would not
+ *        change it
+ *
+ * Covers the bound program, vertex array, framebuffers, the textures per
+ * unit and target, the active texture unit and the blend, depth and other
+ * capabilities. All binds in the program go through this class, otherwise
+ * the cached state no longer matches the context. Objects that are deleted
+ * need to be forgotten, as OpenGL reuses their names.
+ *
+ * State that was never set is unknown, such that the first call always
+ * reaches the driver. Only use from the render thread.
+ */
+class GLState {
+public:
+    static const GLuint UNKNOWN = 0xFFFFFFFF;           //!< state that was never set or was forgotten
+
+    static const unsigned int MAX_UNITS = 8;            //!< texture units that are tracked
+    static const unsigned int NR_TARGETS = 3;           //!< texture targets that are tracked
+    static const unsigned int NR_CAPABILITIES = 4;      //!< capabilities that are tracked
+
+private:
+    GLuint program;                                 //!< program in use
+    GLuint vertex_array;                            //!< bound vertex array
+    GLuint read_framebuffer;                        //!< framebuffer bound for reading
+    GLuint draw_framebuffer;                        //!< framebuffer bound for drawing
+    GLuint active_unit;                             //!< active texture unit
+    GLuint textures[MAX_UNITS][NR_TARGETS];         //!< bound texture per unit and target
+    GLuint capabilities[NR_CAPABILITIES];           //!< enabled (1), disabled (0) or UNKNOWN
+    GLenum blend_src;                               //!< source factor of the blend function
+    GLenum blend_dst;                               //!< destination factor of the blend function
+
+    unsigned int nr_calls;                          //!< calls issued in this frame
+    unsigned int nr_avoided;                        //!< calls skipped in this frame
+    unsigned int nr_calls_last_frame;               //!< calls issued in the last frame
+    unsigned int nr_avoided_last_frame;             //!< calls skipped in the last frame
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the state cache
+     *
+     * @return      reference to the state cache object (singleton pattern)
+     */
+    static GLState& get() {
+        static GLState gl_state_instance;
+        return gl_state_instance;
+    }
+
+    /**
+     * @brief      glUseProgram
+     *
+     * @param[in]  _program  program
+     */
+    void use_program(GLuint _program);
+
+    /**
+     * @brief      glBindVertexArray
+     *
+     * @param[in]  _vertex_array  vertex array
+     */
+    void bind_vertex_array(GLuint _vertex_array);
+
+    /**
+     * @brief      glBindFramebuffer
+     *
+     * @param[in]  target        GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+     * @param[in]  framebuffer   framebuffer
+     */
+    void bind_framebuffer(GLenum target, GLuint framebuffer);
+
+    /**
+     * @brief      glActiveTexture and glBindTexture
+     *
+     *             The unit stays active afterwards, such that the texture
+     *             can be modified with glTex* calls.
+     *
+     * @param[in]  unit     texture unit (0 for GL_TEXTURE0)
+     * @param[in]  target   GL_TEXTURE_2D, GL_TEXTURE_2D_MULTISAMPLE or GL_TEXTURE_BUFFER
+     * @param[in]  texture  texture
+     */
+    void bind_texture(GLuint unit, GLenum target, GLuint texture);
+
+    /**
+     * @brief      glEnable
+     *
+     * @param[in]  capability  GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST or GL_MULTISAMPLE
+     */
+    void enable(GLenum capability);
+
+    /**
+     * @brief      glDisable
+     *
+     * @param[in]  capability  GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST or GL_MULTISAMPLE
+     */
+    void disable(GLenum capability);
+
+    /**
+     * @brief      glBlendFunc
+     *
+     * @param[in]  src   source factor
+     * @param[in]  dst   destination factor
+     */
+    void blend_func(GLenum src, GLenum dst);
+
+    /**
+     * @brief      forget a program that is about to be deleted
+     *
+     * @param[in]  _program  program
+     */
+    void forget_program(GLuint _program);
+
+    /**
+     * @brief      forget a vertex array that is about to be deleted
+     *
+     * @param[in]  _vertex_array  vertex array
+     */
+    void forget_vertex_array(GLuint _vertex_array);
+
+    /**
+     * @brief      forget a framebuffer that is about to be deleted
+     *
+     * @param[in]  framebuffer  framebuffer
+     */
+    void forget_framebuffer(GLuint framebuffer);
+
+    /**
+     * @brief      forget a texture that is about to be deleted
+     *
+     * @param[in]  texture  texture
+     */
+    void forget_texture(GLuint texture);
+
+    /**
+     * @brief      start counting the calls of a new frame
+     */
+    void new_frame();
+
+    /**
+     * @brief      get the number of calls issued in the last frame
+     *
+     * @return     number of calls
+     */
+    inline unsigned int get_nr_calls() const {
+        return this->nr_calls_last_frame;
+    }
+
+    /**
+     * @brief      get the number of calls skipped in the last frame
+     *
+     * @return     number of calls
+     */
+    inline unsigned int get_nr_avoided() const {
+        return this->nr_avoided_last_frame;
+    }
+
+private:
+    /**
+     * @brief       state cache constructor
+     *
+     * @return      state cache instance
+     */
+    GLState();
+
+    /**
+     * @brief      make a texture unit active
+     *
+     * @param[in]  unit  texture unit
+     */
+    void set_active_unit(GLuint unit);
+
+    /**
+     * @brief      get the index of a texture target
+     *
+     * @param[in]  target  texture target
+     *
+     * @return     index in the texture table (NR_TARGETS if not tracked)
+     */
+    static unsigned int get_target_index(GLenum target);
+
+    /**
+     * @brief      get the index of a capability
+     *
+     * @param[in]  capability  capability
+     *
+     * @return     index in the capability table (NR_CAPABILITIES if not tracked)
+     */
+    static unsigned int get_capability_index(GLenum capability);
+
+    GLState(GLState const&)          = delete;
+    void operator=(GLState const&)  = delete;
+};
+
+#endif // _GL_STATE_H
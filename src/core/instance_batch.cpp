@@ -0,0 +1,194 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "instance_batch.h"
+
+/**
+ * @brief      InstanceBatch constructor
+ *
+ * @param      _shader      shader of all instances
+ * @param[in]  _mesh        mesh of all instances
+ * @param[in]  _texture_id  texture of all instances (-1 if none)
+ */
+InstanceBatch::InstanceBatch(Shader* _shader, const Mesh* _mesh, int _texture_id) {
+    this->shader = _shader;
+    this->mesh = _mesh;
+    this->texture_id = _texture_id;
+    this->objects.resize(_mesh->get_nr_lods());
+    this->buffer = 0;
+    this->capacity = 0;
+}
+
+/**
+ * @brief      remove all instances
+ */
+void InstanceBatch::clear() {
+    for(unsigned int i=0; i<this->objects.size(); i++) {
+        this->objects[i].clear();
+    }
+}
+
+/**
+ * @brief      add a visible object
+ *
+ * @param      object  the object
+ * @param[in]  lod     level of detail
+ */
+void InstanceBatch::add(Object* object, unsigned int lod) {
+    this->objects[lod].push_back(object);
+}
+
+/**
+ * @brief      upload the instances and queue a packet per level of detail
+ *
+ * @param[in]  camera  camera position
+ *
+ * @return     number of packets
+ */
+unsigned int InstanceBatch::submit(const glm::vec3& camera) {
+    this->upload();
+
+    unsigned int nr_packets = 0;
+    for(unsigned int lod=0; lod<this->objects.size(); lod++) {
+        if(this->objects[lod].empty()) {
+            continue;
+        }
+
+        // the nearest instance decides where the batch goes in front to back order
+        float depth = glm::length(this->objects[lod][0]->get_position() - camera);
+        for(unsigned int i=1; i<this->objects[lod].size(); i++) {
+            depth = std::min(depth, glm::length(this->objects[lod][i]->get_position() - camera));
+        }
+
+        RenderQueue::get().submit(this, lod, RenderQueue::PASS_OPAQUE, depth);
+        nr_packets++;
+    }
+
+    return nr_packets;
+}
+
+/**
+ * @brief      draw the instances of a level of detail
+ *
+ * @param[in]  lod   level of detail
+ */
+void InstanceBatch::draw(unsigned int lod) {
+    const unsigned int count = this->objects[lod].size();
+    const unsigned int first = this->firsts[lod];
+
+    // all properties but the model matrix are the same for every instance
+    Object* object = this->objects[lod][0];
+    object->set_properties(glm::mat4(1.0f));
+    this->set_instance_attributes(first);
+
+    if(lod == 0 && count == 1 && this->mesh->get_nr_meshlets() > 0) {
+        // a lone object close by keeps its cluster culling; a draw
+        // without instancing reads the first instance of the range
+        const glm::mat4 model = this->instances[first].model;
+        const glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(FrameConstants::get().get_camera_position(), 1.0f));
+        this->mesh->draw_meshlets(Frustum(FrameConstants::get().get_view_projection() * model), camera, object->get_palette());
+    } else {
+        this->mesh->draw_instanced(lod, count);
+    }
+}
+
+/**
+ * @brief      get the number of instances
+ *
+ * @return     number of instances added since the last clear
+ */
+unsigned int InstanceBatch::get_nr_instances() const {
+    unsigned int nr_instances = 0;
+    for(unsigned int i=0; i<this->objects.size(); i++) {
+        nr_instances += this->objects[i].size();
+    }
+
+    return nr_instances;
+}
+
+InstanceBatch::~InstanceBatch() {
+    if(this->buffer != 0) {
+        glDeleteBuffers(1, &this->buffer);
+    }
+}
+
+/**
+ * @brief      upload the instance attributes
+ */
+void InstanceBatch::upload() {
+    this->instances.clear();
+    this->firsts.resize(this->objects.size());
+    for(unsigned int i=0; i<this->objects.size(); i++) {
+        this->firsts[i] = this->instances.size();
+        for(unsigned int j=0; j<this->objects[i].size(); j++) {
+            InstanceData instance;
+            instance.model = this->objects[i][j]->get_model_matrix();
+            instance.palette_offset = this->objects[i][j]->get_palette_offset();
+            this->instances.push_back(instance);
+        }
+    }
+
+    if(this->instances.empty()) {
+        return;
+    }
+
+    if(this->buffer == 0) {
+        glGenBuffers(1, &this->buffer);
+    }
+
+    // grow geometrically, and otherwise orphan the storage of the previous frame
+    if(this->instances.size() > this->capacity) {
+        this->capacity = std::max((unsigned int)this->instances.size(), 2 * this->capacity);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+    glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->instances.size() * sizeof(InstanceData), &this->instances[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief      point the per-instance attributes of the bound vertex array
+ *             at a range of the instance buffer
+ *
+ * @param[in]  first  index of the first instance of the range
+ */
+void InstanceBatch::set_instance_attributes(unsigned int first) const {
+    // the locations are fixed by the attribute types, whatever the layout of the mesh (see Object::load)
+    const GLuint palette_location = ShaderAttribute::INSTANCE_PALETTE_OFFSET;
+    const GLuint model_location = ShaderAttribute::INSTANCE_MODEL;
+    const uintptr_t offset = first * sizeof(InstanceData);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+
+    glEnableVertexAttribArray(palette_location);
+    glVertexAttribIPointer(palette_location, 1, GL_UNSIGNED_INT, sizeof(InstanceData), (const GLvoid*)(offset + sizeof(glm::mat4)));
+    glVertexAttribDivisor(palette_location, 1);
+
+    // a matrix occupies one location per column
+    for(unsigned int i=0; i<4; i++) {
+        glEnableVertexAttribArray(model_location + i);
+        glVertexAttribPointer(model_location + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const GLvoid*)(offset + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(model_location + i, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,163 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _INSTANCE_BATCH_H
+#define _INSTANCE_BATCH_H
+
+#include <vector>
+#include <algorithm>
+#include <GL/glew.h>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "core/object.h"
+#include "core/camera.h"
+#include "core/frustum.h"
+#include "core/render_queue.h"
+#include "core/frame_constants.h"
+
+/**
+ * @brief      attributes of a single instance in the instance buffer
+ */
+struct InstanceData {
+    glm::mat4 model;            //!< model matrix
+    GLuint palette_offset;      //!< first bone of the pose in the PaletteBuffer
+};
+
+/**
+ * @brief      draws all objects that share a mesh, shader and texture with
+ *             a single draw call per level of detail
+ *
+ * The visible objects are collected every frame. Their model matrices and
+ * palette offsets go into a per-instance buffer, which the vertex array of
+ * the mesh reads with a divisor of one, at the fixed locations of the
+ * instance attributes (see Object::load). All other uniforms are shared and are set from the
+ * first object of a level of detail. Every level of detail is a separate
+ * packet in the RenderQueue.
+ */
+class InstanceBatch {
+private:
+    Shader* shader;                             //!< shader of all instances
+    const Mesh* mesh;                           //!< mesh of all instances
+    int texture_id;                             //!< texture of all instances
+
+    std::vector<std::vector<Object*> > objects; //!< visible objects per level of detail
+    std::vector<InstanceData> instances;        //!< instance attributes, finest level of detail first
+    std::vector<unsigned int> firsts;           //!< first instance of every level of detail
+
+    GLuint buffer;                              //!< OpenGL reference to the instance buffer
+    unsigned int capacity;                      //!< number of instances the buffer can hold
+
+public:
+    /**
+     * @brief      InstanceBatch constructor
+     *
+     * @param      _shader      shader of all instances
+     * @param[in]  _mesh        mesh of all instances
+     * @param[in]  _texture_id  texture of all instances (-1 if none)
+     */
+    InstanceBatch(Shader* _shader, const Mesh* _mesh, int _texture_id);
+
+    /**
+     * @brief      whether an object can be drawn in this batch
+     *
+     * @param[in]  object  the object
+     *
+     * @return     true if the object has the same mesh, shader and texture
+     */
+    inline bool matches(const Object* object) const {
+        return object->get_mesh() == this->mesh && object->get_shader() == this->shader && object->get_texture_id() == this->texture_id;
+    }
+
+    /**
+     * @brief      remove all instances
+     */
+    void clear();
+
+    /**
+     * @brief      add a visible object
+     *
+     * @param      object  the object
+     * @param[in]  lod     level of detail
+     */
+    void add(Object* object, unsigned int lod);
+
+    /**
+     * @brief      upload the instances and queue a packet per level of detail
+     *
+     * @param[in]  camera  camera position
+     *
+     * @return     number of packets
+     */
+    unsigned int submit(const glm::vec3& camera);
+
+    /**
+     * @brief      draw the instances of a level of detail
+     *
+     *             Called by the RenderQueue, which has bound the shader,
+     *             texture and mesh. Requires the palettes of this frame to
+     *             be uploaded (see PoseManager::upload_palettes).
+     *
+     * @param[in]  lod   level of detail
+     */
+    void draw(unsigned int lod);
+
+    /**
+     * @brief      get the number of instances
+     *
+     * @return     number of instances added since the last clear
+     */
+    unsigned int get_nr_instances() const;
+
+    inline Shader* get_shader() const {
+        return this->shader;
+    }
+
+    inline const Mesh* get_mesh() const {
+        return this->mesh;
+    }
+
+    inline int get_texture_id() const {
+        return this->texture_id;
+    }
+
+    ~InstanceBatch();
+
+private:
+    InstanceBatch(const InstanceBatch&)     = delete;
+    void operator=(const InstanceBatch&)    = delete;
+
+    /**
+     * @brief      upload the instance attributes
+     */
+    void upload();
+
+    /**
+     * @brief      point the per-instance attributes of the bound vertex
+     *             array at a range of the instance buffer
+     *
+     * @param[in]  first  index of the first instance of the range
+     */
+    void set_instance_attributes(unsigned int first) const;
+};
+
+#endif // _INSTANCE_BATCH_H
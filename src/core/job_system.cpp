@@ -0,0 +1,168 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "job_system.h"
+
+/**
+ * @brief       job system constructor
+ *
+ * @return      job system instance
+ */
+JobSystem::JobSystem() {
+    this->nr_queued = 0;
+    this->flag_stop = false;
+
+    // the calling thread is the first of the threads
+    const unsigned int nr_threads = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned int i=0; i<nr_threads; i++) {
+        this->queues.push_back(new JobQueue());
+    }
+
+    for(unsigned int i=1; i<nr_threads; i++) {
+        this->workers.push_back(std::thread(&JobSystem::worker_loop, this, i));
+    }
+}
+
+/**
+ * @brief      execute a function for all batches of a range and wait
+ *             until all of them are done
+ *
+ * @param[in]  count       number of elements
+ * @param[in]  batch_size  number of elements per batch
+ * @param[in]  func        function receiving the first and one past the
+ *                         last element of a batch
+ */
+void JobSystem::parallel_for(unsigned int count, unsigned int batch_size, const std::function<void(unsigned int, unsigned int)>& func) {
+    batch_size = std::max(batch_size, 1u);
+    const unsigned int nr_batches = (count + batch_size - 1) / batch_size;
+
+    if(nr_batches == 0) {
+        return;
+    }
+
+    if(nr_batches == 1 || this->workers.empty()) {
+        func(0, count);
+        return;
+    }
+
+    std::atomic<unsigned int> remaining(nr_batches);
+
+    // every thread starts on a contiguous part of the range
+    const unsigned int nr_threads = this->queues.size();
+    for(unsigned int t=0; t<nr_threads; t++) {
+        std::lock_guard<std::mutex> lock(this->queues[t]->mutex);
+        for(unsigned int b = t * nr_batches / nr_threads; b < (t + 1) * nr_batches / nr_threads; b++) {
+            const unsigned int begin = b * batch_size;
+            const unsigned int end = std::min(begin + batch_size, count);
+            this->queues[t]->jobs.push_back([&func, &remaining, begin, end]() {
+                func(begin, end);
+                remaining--;
+            });
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->wake_mutex);
+        this->nr_queued += nr_batches;
+    }
+    this->jobs_available.notify_all();
+
+    while(remaining > 0) {
+        if(!this->run_job(0)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(this->wake_mutex);
+        this->flag_stop = true;
+    }
+
+    this->jobs_available.notify_all();
+    for(unsigned int i=0; i<this->workers.size(); i++) {
+        this->workers[i].join();
+    }
+
+    for(unsigned int i=0; i<this->queues.size(); i++) {
+        delete this->queues[i];
+    }
+}
+
+/**
+ * @brief      loop executed by every worker thread
+ *
+ * @param[in]  idx   index of the queue of the thread
+ */
+void JobSystem::worker_loop(unsigned int idx) {
+    while(true) {
+        if(this->run_job(idx)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->wake_mutex);
+        while(this->nr_queued == 0 && !this->flag_stop) {
+            this->jobs_available.wait(lock);
+        }
+
+        if(this->flag_stop) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief      execute a single job of the own queue or of another one
+ *
+ * @param[in]  idx   index of the queue of the thread
+ *
+ * @return     false if no job was available
+ */
+bool JobSystem::run_job(unsigned int idx) {
+    std::function<void()> job;
+
+    // the own queue is worked through front to back, others are robbed from the back
+    for(unsigned int i=0; i<this->queues.size() && !job; i++) {
+        JobQueue* queue = this->queues[(idx + i) % this->queues.size()];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if(queue->jobs.empty()) {
+            continue;
+        }
+
+        if(i == 0) {
+            job = queue->jobs.front();
+            queue->jobs.pop_front();
+        } else {
+            job = queue->jobs.back();
+            queue->jobs.pop_back();
+        }
+    }
+
+    if(!job) {
+        return false;
+    }
+
+    this->nr_queued--;
+    job();
+
+    return true;
+}
@@ -0,0 +1,132 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _JOB_SYSTEM_H
+#define _JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+/**
+ * @class JobSystem class
+ *
+ * @brief executes batches of work on a pool of threads
+ *
+ * Every thread owns a queue of jobs. A parallel loop hands every thread a
+ * contiguous range of batches; a thread takes jobs from the front of its
+ * own queue and, once that is empty, steals from the back of the queues of
+ * the other threads. The calling thread takes part in the work.
+ *
+ * The partition into batches only depends on the number of elements, such
+ * that the result is deterministic as long as the batches do not share
+ * mutable state.
+ */
+class JobSystem {
+private:
+    /**
+     * @brief      jobs of a single thread
+     */
+    struct JobQueue {
+        std::deque<std::function<void()> > jobs;    //!< pending jobs
+        std::mutex mutex;                           //!< guards jobs
+    };
+
+    std::vector<std::thread> workers;               //!< worker threads
+    std::vector<JobQueue*> queues;                  //!< queue of the calling thread followed by those of the workers
+
+    std::mutex wake_mutex;                          //!< guards flag_stop and waiting for jobs
+    std::condition_variable jobs_available;         //!< signals workers that jobs are available
+    std::atomic<unsigned int> nr_queued;            //!< number of jobs that are not yet taken
+    bool flag_stop;                                 //!< whether the workers should terminate
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the job system
+     *
+     * @return      reference to the job system object (singleton pattern)
+     */
+    static JobSystem& get() {
+        static JobSystem job_system_instance;
+        return job_system_instance;
+    }
+
+    /**
+     * @brief      execute a function for all batches of a range and wait
+     *             until all of them are done
+     *
+     *             Must be called from a single thread and not from within
+     *             a job.
+     *
+     * @param[in]  count       number of elements
+     * @param[in]  batch_size  number of elements per batch
+     * @param[in]  func        function receiving the first and one past the
+     *                         last element of a batch
+     */
+    void parallel_for(unsigned int count, unsigned int batch_size, const std::function<void(unsigned int, unsigned int)>& func);
+
+    /**
+     * @brief      get the number of threads that execute jobs
+     *
+     * @return     number of worker threads plus the calling thread
+     */
+    inline unsigned int get_nr_threads() const {
+        return this->queues.size();
+    }
+
+    ~JobSystem();
+
+private:
+    /**
+     * @brief       job system constructor
+     *
+     * @return      job system instance
+     */
+    JobSystem();
+
+    /**
+     * @brief      loop executed by every worker thread
+     *
+     * @param[in]  idx   index of the queue of the thread
+     */
+    void worker_loop(unsigned int idx);
+
+    /**
+     * @brief      execute a single job of the own queue or of another one
+     *
+     * @param[in]  idx   index of the queue of the thread
+     *
+     * @return     false if no job was available
+     */
+    bool run_job(unsigned int idx);
+
+    JobSystem(JobSystem const&)          = delete;
+    void operator=(JobSystem const&)  = delete;
+};
+
+#endif // _JOB_SYSTEM_H
@@ -0,0 +1,170 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "load_statistics.h"
+
+const char* LoadStatistics::REPORT_FILE = "load_report.tsv";
+
+/**
+ * @brief      add a record for an asset
+ *
+ * @param[in]  type  kind of asset
+ * @param[in]  name  filename or description
+ *
+ * @return     record id
+ */
+unsigned int LoadStatistics::add_record(const std::string& type, const std::string& name) {
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+    this->records.push_back(LoadRecord(type, name));
+    return this->records.size() - 1;
+}
+
+/**
+ * @brief      add wall time to a phase
+ *
+ * @param[in]  id       record id (NO_RECORD is ignored)
+ * @param[in]  phase    phase (PHASE_*)
+ * @param[in]  seconds  wall time
+ */
+void LoadStatistics::add_time(unsigned int id, unsigned int phase, double seconds) {
+    if(id == NO_RECORD) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+    this->records[id].phase_times[phase] += seconds;
+}
+
+/**
+ * @brief      add to the number of bytes read from disk
+ *
+ * @param[in]  id     record id (NO_RECORD is ignored)
+ * @param[in]  bytes  number of bytes
+ */
+void LoadStatistics::add_bytes_read(unsigned int id, size_t bytes) {
+    if(id == NO_RECORD) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+    this->records[id].bytes_read += bytes;
+}
+
+/**
+ * @brief      set the memory retained by an asset
+ *
+ * @param[in]  id         record id (NO_RECORD is ignored)
+ * @param[in]  cpu_bytes  CPU bytes
+ * @param[in]  gpu_bytes  GPU bytes
+ */
+void LoadStatistics::set_memory(unsigned int id, size_t cpu_bytes, size_t gpu_bytes) {
+    if(id == NO_RECORD) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+    this->records[id].cpu_bytes = cpu_bytes;
+    this->records[id].gpu_bytes = gpu_bytes;
+}
+
+/**
+ * @brief      set the geometry of an asset
+ *
+ * @param[in]  id           record id (NO_RECORD is ignored)
+ * @param[in]  nr_vertices  number of vertices
+ * @param[in]  nr_indices   number of indices (triangles are derived)
+ */
+void LoadStatistics::set_geometry(unsigned int id, unsigned int nr_vertices, unsigned int nr_indices) {
+    if(id == NO_RECORD) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+    this->records[id].nr_vertices = nr_vertices;
+    this->records[id].nr_indices = nr_indices;
+}
+
+/**
+ * @brief      describe all records as a table
+ *
+ * @return     header, one line per record and a line with totals
+ */
+std::vector<std::string> LoadStatistics::report() const {
+    static const char* row_format = "%-7s %8.1f %8.1f %8.1f %8.1f %9.1f %9.1f %9.1f %7u %7u  %s";
+
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+
+    std::vector<std::string> lines;
+    lines.push_back((boost::format("%-7s %8s %8s %8s %8s %9s %9s %9s %7s %7s  %s") % "load" % "read ms" % "parse ms"
+                     % "proc ms" % "upl ms" % "read KiB" % "cpu KiB" % "gpu KiB" % "verts" % "tris" % "name").str());
+
+    LoadRecord total("total", boost::lexical_cast<std::string>(this->records.size()) + " records");
+    for(unsigned int i=0; i<this->records.size(); i++) {
+        const LoadRecord& r = this->records[i];
+        lines.push_back((boost::format(row_format) % r.type % (r.phase_times[PHASE_READ] * 1e3) % (r.phase_times[PHASE_PARSE] * 1e3)
+                         % (r.phase_times[PHASE_PROCESS] * 1e3) % (r.phase_times[PHASE_UPLOAD] * 1e3) % (r.bytes_read / 1024.0)
+                         % (r.cpu_bytes / 1024.0) % (r.gpu_bytes / 1024.0) % r.nr_vertices % (r.nr_indices / 3) % r.name).str());
+
+        for(unsigned int j=0; j<NUM_PHASES; j++) {
+            total.phase_times[j] += r.phase_times[j];
+        }
+        total.bytes_read += r.bytes_read;
+        total.cpu_bytes += r.cpu_bytes;
+        total.gpu_bytes += r.gpu_bytes;
+        total.nr_vertices += r.nr_vertices;
+        total.nr_indices += r.nr_indices;
+    }
+
+    lines.push_back((boost::format(row_format) % total.type % (total.phase_times[PHASE_READ] * 1e3) % (total.phase_times[PHASE_PARSE] * 1e3)
+                     % (total.phase_times[PHASE_PROCESS] * 1e3) % (total.phase_times[PHASE_UPLOAD] * 1e3) % (total.bytes_read / 1024.0)
+                     % (total.cpu_bytes / 1024.0) % (total.gpu_bytes / 1024.0) % total.nr_vertices % (total.nr_indices / 3) % total.name).str());
+
+    return lines;
+}
+
+/**
+ * @brief      write all records as tab-separated values
+ *
+ * @param[in]  filename  The filename
+ *
+ * @return     true on success
+ */
+bool LoadStatistics::write(const std::string& filename) const {
+    std::ofstream f(filename.c_str(), std::ios::trunc);
+    if(!f.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+
+    f << "type\tname\tread_s\tparse_s\tprocess_s\tupload_s\tbytes_read\tcpu_bytes\tgpu_bytes\tvertices\tindices\ttriangles" << std::endl;
+    for(unsigned int i=0; i<this->records.size(); i++) {
+        const LoadRecord& r = this->records[i];
+        f << r.type << "\t" << r.name;
+        for(unsigned int j=0; j<NUM_PHASES; j++) {
+            f << "\t" << r.phase_times[j];
+        }
+        f << "\t" << r.bytes_read << "\t" << r.cpu_bytes << "\t" << r.gpu_bytes
+          << "\t" << r.nr_vertices << "\t" << r.nr_indices << "\t" << (r.nr_indices / 3) << std::endl;
+    }
+
+    return f.good();
+}
@@ -0,0 +1,214 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _LOAD_STATISTICS_H
+#define _LOAD_STATISTICS_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+
+#include <boost/chrono.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+
+/**
+ * @class LoadStatistics class
+ *
+ * @brief collects load times and memory footprints of all assets
+ *
+ * Every mesh, texture, shader, font and the terrain add a record when they
+ * are constructed and report the wall time spent per phase (read, parse,
+ * process, upload) as well as the bytes read, the memory they retain and
+ * their geometry. Records may be updated from the asset loader threads.
+ */
+class LoadStatistics {
+public:
+    enum {
+        PHASE_READ,         //!< reading the file from disk
+        PHASE_PARSE,        //!< decoding the file contents
+        PHASE_PROCESS,      //!< deriving data (welding, LODs, compilation, distance fields)
+        PHASE_UPLOAD,       //!< creating the OpenGL objects
+
+        NUM_PHASES
+    };
+
+    /**
+     * @brief      statistics of a single asset
+     */
+    struct LoadRecord {
+        std::string type;                   //!< kind of asset
+        std::string name;                   //!< filename or description
+        double phase_times[NUM_PHASES];     //!< wall time per phase in seconds
+        size_t bytes_read;                  //!< bytes read from disk
+        size_t cpu_bytes;                   //!< CPU bytes retained after loading
+        size_t gpu_bytes;                   //!< GPU bytes retained after loading
+        unsigned int nr_vertices;           //!< number of vertices
+        unsigned int nr_indices;            //!< number of indices
+
+        LoadRecord(const std::string& _type, const std::string& _name) :
+            type(_type),
+            name(_name),
+            bytes_read(0),
+            cpu_bytes(0),
+            gpu_bytes(0),
+            nr_vertices(0),
+            nr_indices(0) {
+            for(unsigned int i=0; i<NUM_PHASES; i++) {
+                this->phase_times[i] = 0.0;
+            }
+        }
+    };
+
+private:
+    std::vector<LoadRecord> records;        //!< records in order of creation
+    mutable std::mutex records_mutex;       //!< guards records
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the load statistics
+     *
+     * @return      reference to the load statistics object (singleton pattern)
+     */
+    static LoadStatistics& get() {
+        static LoadStatistics load_statistics_instance;
+        return load_statistics_instance;
+    }
+
+    /**
+     * @brief      add a record for an asset
+     *
+     * @param[in]  type  kind of asset
+     * @param[in]  name  filename or description
+     *
+     * @return     record id
+     */
+    unsigned int add_record(const std::string& type, const std::string& name);
+
+    /**
+     * @brief      add wall time to a phase
+     *
+     * @param[in]  id       record id (NO_RECORD is ignored)
+     * @param[in]  phase    phase (PHASE_*)
+     * @param[in]  seconds  wall time
+     */
+    void add_time(unsigned int id, unsigned int phase, double seconds);
+
+    /**
+     * @brief      add to the number of bytes read from disk
+     *
+     * @param[in]  id     record id (NO_RECORD is ignored)
+     * @param[in]  bytes  number of bytes
+     */
+    void add_bytes_read(unsigned int id, size_t bytes);
+
+    /**
+     * @brief      set the memory retained by an asset
+     *
+     * @param[in]  id         record id (NO_RECORD is ignored)
+     * @param[in]  cpu_bytes  CPU bytes
+     * @param[in]  gpu_bytes  GPU bytes
+     */
+    void set_memory(unsigned int id, size_t cpu_bytes, size_t gpu_bytes);
+
+    /**
+     * @brief      set the geometry of an asset
+     *
+     * @param[in]  id           record id (NO_RECORD is ignored)
+     * @param[in]  nr_vertices  number of vertices
+     * @param[in]  nr_indices   number of indices (triangles are derived)
+     */
+    void set_geometry(unsigned int id, unsigned int nr_vertices, unsigned int nr_indices);
+
+    /**
+     * @brief      describe all records as a table
+     *
+     * @return     header, one line per record and a line with totals
+     */
+    std::vector<std::string> report() const;
+
+    /**
+     * @brief      write all records as tab-separated values
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true on success
+     */
+    bool write(const std::string& filename) const;
+
+    static const unsigned int NO_RECORD = (unsigned int)-1;    //!< id that is never recorded
+    static const char* REPORT_FILE;                             //!< file written at exit
+
+private:
+    /**
+     * @brief       load statistics constructor
+     *
+     * @return      load statistics instance
+     */
+    LoadStatistics() {}
+
+    LoadStatistics(LoadStatistics const&)     = delete;
+    void operator=(LoadStatistics const&)  = delete;
+};
+
+/**
+ * @brief      adds the wall time of its own lifetime to a phase
+ */
+class LoadTimer {
+private:
+    unsigned int id;                                                //!< record id
+    unsigned int phase;                                             //!< phase (LoadStatistics::PHASE_*)
+    boost::chrono::high_resolution_clock::time_point start;        //!< construction time
+
+public:
+    /**
+     * @brief      LoadTimer constructor
+     *
+     * @param[in]  _id     record id
+     * @param[in]  _phase  phase
+     */
+    LoadTimer(unsigned int _id, unsigned int _phase) :
+        id(_id),
+        phase(_phase),
+        start(boost::chrono::high_resolution_clock::now()) {}
+
+    /**
+     * @brief      add the elapsed time and continue timing another phase
+     *
+     * @param[in]  _phase  next phase
+     */
+    inline void next_phase(unsigned int _phase) {
+        const boost::chrono::high_resolution_clock::time_point now = boost::chrono::high_resolution_clock::now();
+        LoadStatistics::get().add_time(this->id, this->phase, boost::chrono::duration<double>(now - this->start).count());
+        this->phase = _phase;
+        this->start = now;
+    }
+
+    ~LoadTimer() {
+        const boost::chrono::duration<double> elapsed = boost::chrono::high_resolution_clock::now() - this->start;
+        LoadStatistics::get().add_time(this->id, this->phase, elapsed.count());
+    }
+};
+
+#endif // _LOAD_STATISTICS_H
@@ -20,11 +20,84 @@
 
 #include "mesh.h"
 
+#include <map>
+#include <deque>
+#include <random>
+
+// map a value in [0,1] onto an unsigned normalized 16 bit integer
+static uint16_t quantize_unorm16(float v);
+
+// map a value in [-1,1] onto a signed normalized 16 bit integer
+static int16_t quantize_snorm16(float v);
+
+// map a value in [0,1] onto an unsigned normalized 8 bit integer
+static uint8_t quantize_unorm8(float v);
+
+// quantize bone weights to unorm8 such that they keep summing to 255
+static void quantize_weights(const glm::vec4& w, uint8_t* q);
+
+// project a unit vector onto the octahedron and unfold it onto the unit square
+static glm::vec2 encode_octahedral(const glm::vec3& n);
+
+// fold an octahedral encoded normal back onto the unit sphere (as in the shaders)
+static glm::vec3 decode_octahedral(const glm::vec2& e);
+
+// smallest sphere enclosing a set of points (Welzl)
+static BoundingSphere minimum_bounding_sphere(std::vector<glm::vec3> points);
+
+// smallest sphere with up to four points on its surface
+static BoundingSphere circumscribed_sphere(const glm::vec3* p, unsigned int n);
+
+// write the elements of a vector to a binary stream
+template <typename T> static void write_array(std::ofstream& f, const std::vector<T>& v);
+
+// copy elements from a memory-mapped file; returns false when the file is truncated
+template <typename T> static bool read_array(const uint8_t** ptr, const uint8_t* end, unsigned int n, std::vector<T>* v);
+
+/**
+ * @brief      header of a binary .imesh file
+ */
+struct MeshFileHeader {
+    char magic[4];                  //!< "IMSH"
+    uint32_t version;               //!< Mesh::BINARY_FILE_VERSION
+    uint32_t nr_positions;
+    uint32_t nr_normals;
+    uint32_t nr_colors;
+    uint32_t nr_texture_coordinates;
+    uint32_t nr_indices;
+    uint32_t nr_bone_indices;
+    uint32_t nr_meshlets;
+    uint32_t nr_lods;
+    uint32_t nr_lod_indices;
+    uint32_t nr_bones;
+    uint32_t nr_animation_clips;
+    BoundingBox bounding_box;
+    BoundingSphere bounding_sphere;
+    BoundingSphere pose_bounding_sphere;
+};
+
+std::atomic<size_t> Mesh::total_cpu_memory(0);
+std::atomic<size_t> Mesh::total_gpu_memory(0);
+
 /**
  * @brief      Mesh constructor
  */
 Mesh::Mesh() {
     this->armature = NULL;
+    this->vertex_stride = 0;
+    this->vertex_compression = 0;
+    this->position_offset = glm::vec3(0.0f);
+    this->position_scale = glm::vec3(1.0f);
+    this->normal_encoding = NORMAL_ENCODING_VEC3;
+    this->flag_loaded = false;
+    this->flag_failed = false;
+    this->gpu_memory = 0;
+    this->accounted_cpu_memory = 0;
+    this->cpu_retention = RETAIN_ALL;
+    this->mesh_type = 0;
+    this->nr_vertices = 0;
+    this->nr_indices = 0;
+    this->load_record = LoadStatistics::NO_RECORD;
 }
 
 /**
@@ -34,6 +107,20 @@ Mesh::Mesh() {
  */
 Mesh::Mesh(const std::string& filename) {
     this->armature = NULL;
+    this->vertex_stride = 0;
+    this->vertex_compression = 0;
+    this->position_offset = glm::vec3(0.0f);
+    this->position_scale = glm::vec3(1.0f);
+    this->normal_encoding = NORMAL_ENCODING_VEC3;
+    this->flag_loaded = false;
+    this->flag_failed = false;
+    this->gpu_memory = 0;
+    this->accounted_cpu_memory = 0;
+    this->cpu_retention = RETAIN_ALL;
+    this->mesh_type = 0;
+    this->nr_vertices = 0;
+    this->nr_indices = 0;
+    this->load_record = LoadStatistics::NO_RECORD;
     this->load_mesh_from_file(filename);
 }
 
@@ -41,103 +128,52 @@ Mesh::Mesh(const std::string& filename) {
  * @brief      load the mesh on the GPU
  */
 void Mesh::static_load() {
+    // there is nothing to upload for meshes whose file could not be read
+    if(this->flag_failed) {
+        return;
+    }
+
+    // meshes that were not loaded from a file are recorded at upload
+    if(this->load_record == LoadStatistics::NO_RECORD) {
+        this->load_record = LoadStatistics::get().add_record("mesh", "(generated)");
+    }
+    LoadTimer timer(this->load_record, LoadStatistics::PHASE_UPLOAD);
+
     // load the mesh into memory
     unsigned int size = this->indices.size();
 
-    unsigned int vertex_id = 0;
+    // pack all attributes into a single strided buffer
+    this->build_vertex_layout();
+    const std::vector<uint8_t> vertices = this->build_vertex_buffer();
 
     // generate a vertex array object and store it in the pointer
     glGenVertexArrays(1, &this->m_vertex_array_object);
-    glBindVertexArray(this->m_vertex_array_object);
+    GLState::get().bind_vertex_array(this->m_vertex_array_object);
 
     // generate a number of buffers (blocks of data on the GPU)
     glGenBuffers(NUM_BUFFERS, this->m_vertex_array_buffers);
 
     /*
-     * POSITIONS
+     * VERTEX_VB
      */
 
-    // bind a buffer identified by POSITION_VB and interpret this buffer as an array
-    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_array_buffers[POSITION_VB]);
+    // bind a buffer identified by VERTEX_VB and interpret this buffer as an array
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_array_buffers[VERTEX_VB]);
     // fill the buffer with data
-    glBufferData(GL_ARRAY_BUFFER, this->positions.size() * 3 * sizeof(float), &this->positions[0][0], GL_STATIC_DRAW);
-
-    // specifies the generic vertex attribute of index 0 to be enabled
-    glEnableVertexAttribArray(vertex_id);
-    // define an array of generic vertex attribute data
-    glVertexAttribPointer(vertex_id, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size(), &vertices[0], GL_STATIC_DRAW);
 
-    /*
-     * NORMALS
-     */
-
-    // up the vertex_id
-     vertex_id++;
-    // bind a buffer identified by POSITION_VB and interpret this buffer as an array
-    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_array_buffers[NORMAL_VB]);
-    // fill the buffer with data
-    glBufferData(GL_ARRAY_BUFFER, this->normals.size() * 3 * sizeof(float), &this->normals[0][0], GL_STATIC_DRAW);
+    // every attribute reads from the same buffer at its own offset; its location
+    // is fixed by its type, such that meshes with different layouts share programs
+    for(unsigned int i=0; i<this->vertex_layout.size(); i++) {
+        const VertexAttribute& attr = this->vertex_layout[i];
 
-    // specifies the generic vertex attribute of index 0 to be enabled
-    glEnableVertexAttribArray(vertex_id);
-    // define an array of generic vertex attribute data
-    glVertexAttribPointer(vertex_id, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-
-    if(this->colors.size() > 0) {
-        /*
-         * COLORS
-         */
-
-         // up the vertex_id
-        vertex_id++;
-        // bind a buffer identified by POSITION_VB and interpret this buffer as an array
-        glBindBuffer(GL_ARRAY_BUFFER, m_vertex_array_buffers[COLOR_VB]);
-        // fill the buffer with data
-        glBufferData(GL_ARRAY_BUFFER, this->colors.size() * 4 * sizeof(float), &this->colors[0][0], GL_STATIC_DRAW);
-
-        // specifies the generic vertex attribute of index 0 to be enabled
-        glEnableVertexAttribArray(vertex_id);
-        // define an array of generic vertex attribute data
-        glVertexAttribPointer(vertex_id, 4, GL_FLOAT, GL_FALSE, 0, 0);
-    }
-
-    if(this->texture_coordinates.size() > 0) {
-        /*
-         * TEXTURE COORDINATES
-         */
-
-         // up the vertex_id
-        vertex_id++;
-        // bind a buffer identified by POSITION_VB and interpret this buffer as an array
-        glBindBuffer(GL_ARRAY_BUFFER, m_vertex_array_buffers[TEXTURE_VB]);
-        // fill the buffer with data
-        glBufferData(GL_ARRAY_BUFFER, this->texture_coordinates.size() * 2 * sizeof(float), &this->texture_coordinates[0][0], GL_STATIC_DRAW);
-
-        // specifies the generic vertex attribute of index 0 to be enabled
-        glEnableVertexAttribArray(vertex_id);
+        // specifies the generic vertex attribute at the location of the type to be enabled
+        glEnableVertexAttribArray(attr.type);
         // define an array of generic vertex attribute data
-        glVertexAttribPointer(vertex_id, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    }
-
-    if(this->armature) {
-        if(this->armature->get_nr_bones() > 0) {
-            /*
-             * BONE WEIGHTS
-             */
-            const std::vector<float> weights = this->armature->get_weights_vector();
-
-             // up the vertex_id
-            vertex_id++;
-            // bind a buffer identified by POSITION_VB and interpret this buffer as an array
-            glBindBuffer(GL_ARRAY_BUFFER, m_vertex_array_buffers[WEIGHTS_VB]);
-            // fill the buffer with data
-            glBufferData(GL_ARRAY_BUFFER, weights.size() * sizeof(float), &weights[0], GL_STATIC_DRAW);
-
-            // specifies the generic vertex attribute of index 0 to be enabled
-            glEnableVertexAttribArray(vertex_id);
-            // define an array of generic vertex attribute data
-            glVertexAttribPointer(vertex_id, this->armature->get_nr_bones(), GL_FLOAT, GL_FALSE, 0, 0);
+        if(attr.integer) {
+            glVertexAttribIPointer(attr.type, attr.components, attr.format, this->vertex_stride, (const GLvoid*)(uintptr_t)attr.offset);
+        } else {
+            glVertexAttribPointer(attr.type, attr.components, attr.format, attr.normalized, this->vertex_stride, (const GLvoid*)(uintptr_t)attr.offset);
         }
     }
 
@@ -145,14 +181,37 @@ void Mesh::static_load() {
      * INDICES_VB
      */
 
+    // meshes without a LOD chain only have the full resolution level
+    if(this->lods.empty()) {
+        this->lods.push_back(MeshLod(0, size, 0.0f));
+    }
+
     // bind a buffer identified by INDICES_VB and interpret this buffer as an array
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vertex_array_buffers[INDICES_VB]);
-    // fill the buffer with data
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size * sizeof(unsigned int), &this->indices[0], GL_STATIC_DRAW);
+    // allocate room for all levels of detail; the full resolution indices come first
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (size + this->lod_indices.size()) * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, size * sizeof(unsigned int), &this->indices[0]);
+    if(!this->lod_indices.empty()) {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, size * sizeof(unsigned int), this->lod_indices.size() * sizeof(unsigned int), &this->lod_indices[0]);
+    }
 
     // after this command, any commands that use a vertex array will
     // no longer work
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
+
+    this->gpu_memory = vertices.size() + (size + this->lod_indices.size()) * sizeof(unsigned int);
+    total_gpu_memory += this->gpu_memory;
+
+    // only counts remain available once the CPU-side data is released
+    this->mesh_type = this->get_type();
+    this->nr_vertices = this->positions.size();
+    this->nr_indices = size;
+    this->flag_loaded = true;
+
+    this->release_cpu_data();
+
+    LoadStatistics::get().set_memory(this->load_record, this->get_cpu_memory(), this->gpu_memory);
+    LoadStatistics::get().set_geometry(this->load_record, this->nr_vertices, this->nr_indices);
 }
 
 void Mesh::load_square_mesh() {
@@ -173,29 +232,127 @@ void Mesh::load_square_mesh() {
  * @brief      draw the mesh
  */
 void Mesh::draw() const {
-    // load the vertex array
-    glBindVertexArray(m_vertex_array_object);
+    // load the vertex array (no-op when the caller has bound it already)
+    GLState::get().bind_vertex_array(m_vertex_array_object);
 
     // draw the mesh using the indices
-    glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, this->get_nr_indices(), GL_UNSIGNED_INT, 0);
+}
 
-    // after this command, any commands that use a vertex array will
-    // no longer work
-    glBindVertexArray(0);
+/**
+ * @brief      draw a level of detail of the mesh
+ *
+ * @param[in]  lod   level of detail (0 is full resolution)
+ */
+void Mesh::draw(unsigned int lod) const {
+    const MeshLod& range = this->lods[lod];
+
+    glDrawElements(GL_TRIANGLES, range.count, GL_UNSIGNED_INT, (const GLvoid*)(uintptr_t)(range.offset * sizeof(unsigned int)));
+}
+
+/**
+ * @brief      draw several instances of a level of detail of the mesh
+ *
+ * @param[in]  lod           level of detail (0 is full resolution)
+ * @param[in]  nr_instances  number of instances
+ */
+void Mesh::draw_instanced(unsigned int lod, unsigned int nr_instances) const {
+    const MeshLod& range = this->lods[lod];
+
+    glDrawElementsInstanced(GL_TRIANGLES, range.count, GL_UNSIGNED_INT, (const GLvoid*)(uintptr_t)(range.offset * sizeof(unsigned int)), nr_instances);
+}
+
+/**
+ * @brief      draw the meshlets that are potentially visible
+ *
+ * @param[in]  frustum  view frustum in model space
+ * @param[in]  camera   camera position in model space
+ * @param[in]  palette  bone matrices of the current pose (NULL if unknown)
+ *
+ * @return     number of visible meshlets
+ */
+unsigned int Mesh::draw_meshlets(const Frustum& frustum, const glm::vec3& camera, const glm::mat4* palette) const {
+    std::vector<GLsizei> counts;
+    std::vector<const GLvoid*> offsets;
+    unsigned int nr_visible = 0;
+    unsigned int end = 0;
+
+    for(unsigned int i=0; i<this->meshlets.size(); i++) {
+        const Meshlet& m = this->meshlets[i];
+
+        if(m.bone != MESHLET_DEFORMING && (m.bone == MESHLET_STATIC || palette != NULL)) {
+            glm::vec3 center = m.center;
+            glm::vec3 axis = m.cone_axis;
+
+            // rigidly skinned clusters follow their bone (row vector convention, see Armature)
+            if(m.bone >= 0) {
+                center = glm::vec3(glm::vec4(center, 1.0f) * palette[m.bone]);
+                axis = glm::vec3(glm::vec4(axis, 0.0f) * palette[m.bone]);
+            }
+
+            if(!frustum.intersects_sphere(center, m.radius)) {
+                continue;
+            }
+
+            // every triangle of the cluster faces away from the camera
+            const glm::vec3 d = center - camera;
+            if(glm::dot(d, axis) >= m.cone_cutoff * glm::length(d) + m.radius) {
+                continue;
+            }
+        }
+
+        nr_visible++;
+
+        // merge consecutive ranges into a single draw
+        if(!counts.empty() && end == m.offset) {
+            counts.back() += m.count;
+        } else {
+            counts.push_back(m.count);
+            offsets.push_back((const GLvoid*)(uintptr_t)(m.offset * sizeof(unsigned int)));
+        }
+        end = m.offset + m.count;
+    }
+
+    if(counts.empty()) {
+        return 0;
+    }
+
+    glMultiDrawElements(GL_TRIANGLES, &counts[0], GL_UNSIGNED_INT, &offsets[0], counts.size());
+
+    return nr_visible;
+}
+
+/**
+ * @brief      select the coarsest level of detail that is visually
+ *             indistinguishable from the full resolution mesh
+ *
+ * @param[in]  pixels_per_unit  projected size of one model unit in pixels
+ * @param[in]  max_error        largest allowed error in pixels
+ *
+ * @return     level of detail
+ */
+unsigned int Mesh::select_lod(float pixels_per_unit, float max_error) const {
+    for(unsigned int i=this->lods.size(); i>1; i--) {
+        if(this->lods[i-1].error * pixels_per_unit <= max_error) {
+            return i-1;
+        }
+    }
+
+    return 0;
 }
 
 /**
  * @brief      bind the vertex attribute array
  */
 void Mesh::bind() const {
-    glBindVertexArray(this->m_vertex_array_object);
+    GLState::get().bind_vertex_array(this->m_vertex_array_object);
 }
 
 /**
  * @brief      unbind the vertex attribute array
  */
 void Mesh::unbind() const {
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
 }
 
 /**
@@ -204,6 +361,10 @@ void Mesh::unbind() const {
  * @return     mesh type
  */
 unsigned int Mesh::get_type() const {
+    if(this->flag_loaded) {
+        return this->mesh_type;
+    }
+
     unsigned int type = 0;
 
     if(this->positions.size() > 0) {
@@ -222,7 +383,8 @@ unsigned int Mesh::get_type() const {
         type |= this->MESH_TEXTURE_COORDINATES;
     }
 
-    if(this->get_bone_size() > 0) {
+    // a rigged mesh without SkinWeights has bones, but nothing to skin
+    if(this->get_bone_size() > 0 && this->bone_weights.size() == this->positions.size()) {
         type |= this->MESH_ARMATURE;
     }
 
@@ -243,59 +405,1021 @@ unsigned int Mesh::get_bone_size() const {
 }
 
 /**
- * @brief      center the vertex coordinates around the origin in model space
+ * @brief      Find an animation clip by its name.
+ *
+ * @param[in]  name  name of the clip
+ *
+ * @return     pointer to the clip (NULL if the mesh has no such clip)
  */
-void Mesh::center() {
-    double sum_x = 0.0;
-    double sum_y = 0.0;
-    double sum_z = 0.0;
+const AnimationClip* Mesh::find_animation_clip(const std::string& name) const {
+    for(unsigned int i=0; i<this->animation_clips.size(); i++) {
+        if(this->animation_clips[i]->get_name() == name) {
+            return this->animation_clips[i];
+        }
+    }
 
-    for(unsigned int i=0; i<this->positions.size(); i++) {
-        sum_x += this->positions[i].x;
-        sum_y += this->positions[i].y;
-        sum_z += this->positions[i].z;
+    return NULL;
+}
+
+/**
+ * @brief      Get an axis-aligned box that encloses the mesh in every pose
+ *
+ * @return     bounding box in model space
+ */
+BoundingBox Mesh::get_pose_bounding_box() const {
+    if(this->get_bone_size() == 0) {
+        return this->bounding_box;
     }
 
-    double n_items = (double)this->positions.size();
-    glm::vec3 center(sum_x / n_items,
-                     sum_y / n_items,
-                     sum_z / n_items);
+    const glm::vec3 r(this->pose_bounding_sphere.radius);
+    return BoundingBox(this->pose_bounding_sphere.center - r, this->pose_bounding_sphere.center + r);
+}
 
+/**
+ * @brief      compute the bounding box and bounding spheres
+ */
+void Mesh::compute_bounding_volumes() {
+    if(this->positions.empty()) {
+        this->bounding_box = BoundingBox();
+        this->bounding_sphere = BoundingSphere();
+        this->pose_bounding_sphere = BoundingSphere();
+        return;
+    }
+
+    glm::vec3 pmin = this->positions[0];
+    glm::vec3 pmax = this->positions[0];
+    for(unsigned int i=1; i<this->positions.size(); i++) {
+        pmin = glm::min(pmin, this->positions[i]);
+        pmax = glm::max(pmax, this->positions[i]);
+    }
+    this->bounding_box = BoundingBox(pmin, pmax);
+    this->bounding_sphere = minimum_bounding_sphere(this->positions);
+    this->pose_bounding_sphere = this->bounding_sphere;
+
+    const unsigned int nr_bones = this->get_bone_size();
+    if(nr_bones == 0 || this->bone_weights.size() != this->positions.size()) {
+        return;
+    }
+
+    // joint positions in model space (row vector convention, see Armature)
+    std::vector<glm::vec3> joints(nr_bones);
+    for(unsigned int i=0; i<nr_bones; i++) {
+        joints[i] = glm::vec3(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) * glm::inverse(this->armature->get_offset_matrix(i)));
+    }
+
+    // besides rotating, the keys of the clips may translate and scale a bone;
+    // gather the longest translation (for roots: the largest displacement of
+    // the joint) and the largest scale of every bone over all keys
+    std::vector<float> translation(nr_bones, 0.0f);
+    std::vector<float> scale(nr_bones, 1.0f);
+    for(unsigned int c=0; c<this->animation_clips.size(); c++) {
+        const std::vector<AnimationTrack>& tracks = this->animation_clips[c]->get_tracks();
+        const std::vector<glm::vec4>& values = this->animation_clips[c]->get_values();
+
+        for(unsigned int t=0; t<tracks.size(); t++) {
+            const unsigned int b = tracks[t].bone;
+            if(b >= nr_bones) {
+                continue;
+            }
+
+            const bool root = this->armature->get_parent(b) < 0;
+            for(unsigned int k=tracks[t].position.first; k<tracks[t].position.first + tracks[t].position.count; k++) {
+                const glm::vec3 p(values[k]);
+                translation[b] = std::max(translation[b], glm::length(root ? p - joints[b] : p));
+            }
+            for(unsigned int k=tracks[t].scale.first; k<tracks[t].scale.first + tracks[t].scale.count; k++) {
+                scale[b] = std::max(scale[b], std::max(std::fabs(values[k].x), std::max(std::fabs(values[k].y), std::fabs(values[k].z))));
+            }
+        }
+    }
+
+    // reach of every bone: the distance of its joint to the rest position of
+    // the root joint can never exceed the summed (scaled) lengths of the bones
+    // in its chain (parents precede their children, see Armature); growth is
+    // the largest scale a bone inherits from its chain
+    std::vector<float> reach(nr_bones, 0.0f);
+    std::vector<float> growth(nr_bones, 1.0f);
+    std::vector<glm::vec3> roots(nr_bones);
+    for(unsigned int i=0; i<nr_bones; i++) {
+        const int parent = this->armature->get_parent(i);
+        if(parent >= 0) {
+            const float length = std::max(glm::length(joints[i] - joints[parent]), translation[i]);
+            reach[i] = reach[parent] + growth[parent] * length;
+            growth[i] = growth[parent] * scale[i];
+            roots[i] = roots[parent];
+        } else {
+            reach[i] = translation[i];
+            growth[i] = scale[i];
+            roots[i] = joints[i];
+        }
+    }
+
+    // add the furthest vertex skinned by each bone; linear blend skinning
+    // keeps every vertex inside the union of these spheres
+    std::vector<float> extent(nr_bones, 0.0f);
     for(unsigned int i=0; i<this->positions.size(); i++) {
-        this->positions[i] -= center;
+        for(unsigned int k=0; k<MAX_BONE_INFLUENCES; k++) {
+            if(this->bone_weights[i][k] > 0.0f) {
+                const unsigned int j = this->bone_indices[i][k];
+                extent[j] = std::max(extent[j], glm::length(this->positions[i] - joints[j]));
+            }
+        }
+    }
+
+    const glm::vec3 center = roots[0];
+    float radius = 0.0f;
+    for(unsigned int j=0; j<nr_bones; j++) {
+        radius = std::max(radius, glm::length(roots[j] - center) + reach[j] + growth[j] * extent[j]);
+    }
+    this->pose_bounding_sphere = BoundingSphere(center, radius);
+}
+
+/**
+ * @brief      split the full resolution indices into meshlets
+ */
+void Mesh::build_meshlets() {
+    this->meshlets.clear();
+
+    // small meshes are culled as a whole
+    const unsigned int nr_triangles = this->indices.size() / 3;
+    if(nr_triangles < 2 * MESHLET_MAX_TRIANGLES) {
+        return;
+    }
+
+    std::vector<int> triangle_bones(nr_triangles);
+    std::vector<std::vector<unsigned int> > vertex_triangles(this->positions.size());
+    for(unsigned int t=0; t<nr_triangles; t++) {
+        triangle_bones[t] = this->get_triangle_bone(t);
+        for(unsigned int k=0; k<3; k++) {
+            vertex_triangles[this->indices[t*3+k]].push_back(t);
+        }
+    }
+
+    std::vector<bool> assigned(nr_triangles, false);
+    std::vector<int> vertex_meshlet(this->positions.size(), -1);
+    std::vector<unsigned int> reordered;
+    reordered.reserve(this->indices.size());
+
+    unsigned int seed = 0;
+    while(true) {
+        while(seed < nr_triangles && assigned[seed]) {
+            seed++;
+        }
+        if(seed == nr_triangles) {
+            break;
+        }
+
+        const int id = this->meshlets.size();
+        Meshlet m;
+        m.offset = reordered.size();
+        m.bone = triangle_bones[seed];
+
+        unsigned int nr_vertices = 0;
+        unsigned int nr_meshlet_triangles = 0;
+        unsigned int next = seed;
+        std::deque<unsigned int> frontier(1, seed);
+
+        while(nr_meshlet_triangles < MESHLET_MAX_TRIANGLES) {
+            // grow over shared vertices; continue in index order when the cluster is closed
+            unsigned int t = nr_triangles;
+            while(!frontier.empty() && t == nr_triangles) {
+                if(!assigned[frontier.front()] && triangle_bones[frontier.front()] == m.bone) {
+                    t = frontier.front();
+                }
+                frontier.pop_front();
+            }
+            if(t == nr_triangles) {
+                while(next < nr_triangles && assigned[next]) {
+                    next++;
+                }
+                if(next == nr_triangles || triangle_bones[next] != m.bone) {
+                    break;
+                }
+                t = next;
+            }
+
+            unsigned int new_vertices = 0;
+            for(unsigned int k=0; k<3; k++) {
+                new_vertices += (vertex_meshlet[this->indices[t*3+k]] != id) ? 1 : 0;
+            }
+            if(nr_vertices + new_vertices > MESHLET_MAX_VERTICES) {
+                break;
+            }
+
+            assigned[t] = true;
+            nr_meshlet_triangles++;
+            for(unsigned int k=0; k<3; k++) {
+                const unsigned int v = this->indices[t*3+k];
+                reordered.push_back(v);
+                if(vertex_meshlet[v] != id) {
+                    vertex_meshlet[v] = id;
+                    nr_vertices++;
+                    frontier.insert(frontier.end(), vertex_triangles[v].begin(), vertex_triangles[v].end());
+                }
+            }
+        }
+
+        m.count = reordered.size() - m.offset;
+
+        // bounding sphere and normal cone of the cluster
+        std::vector<glm::vec3> points;
+        glm::vec3 axis(0.0f);
+        std::vector<glm::vec3> normals;
+        for(unsigned int i=m.offset; i<m.offset + m.count; i+=3) {
+            const glm::vec3& p0 = this->positions[reordered[i]];
+            const glm::vec3& p1 = this->positions[reordered[i+1]];
+            const glm::vec3& p2 = this->positions[reordered[i+2]];
+            points.push_back(p0);
+            points.push_back(p1);
+            points.push_back(p2);
+
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const float l = glm::length(n);
+            if(l > 0.0f) {
+                normals.push_back(n / l);
+                axis += normals.back();
+            }
+        }
+
+        const BoundingSphere sphere = minimum_bounding_sphere(points);
+        m.center = sphere.center;
+        m.radius = sphere.radius;
+
+        const float axis_length = glm::length(axis);
+        if(axis_length > 1e-6f) {
+            m.cone_axis = axis / axis_length;
+            float min_dot = 1.0f;
+            for(unsigned int i=0; i<normals.size(); i++) {
+                min_dot = std::min(min_dot, glm::dot(m.cone_axis, normals[i]));
+            }
+            m.cone_cutoff = (min_dot <= 0.0f) ? 1.0f : std::sqrt(1.0f - min_dot * min_dot);
+        }
+
+        this->meshlets.push_back(m);
+    }
+
+    this->indices.swap(reordered);
+}
+
+/**
+ * @brief      get the bone that moves a triangle rigidly
+ *
+ * @param[in]  t     index of the triangle
+ *
+ * @return     bone index, MESHLET_STATIC or MESHLET_DEFORMING
+ */
+int Mesh::get_triangle_bone(unsigned int t) const {
+    if(this->bone_weights.empty()) {
+        return MESHLET_STATIC;
+    }
+
+    const unsigned int bone = this->bone_indices[this->indices[t*3]][0];
+    for(unsigned int k=0; k<3; k++) {
+        const unsigned int v = this->indices[t*3+k];
+        if(this->bone_indices[v][0] != bone || this->bone_weights[v][0] < 0.999f) {
+            return MESHLET_DEFORMING;
+        }
+    }
+
+    return (int)bone;
+}
+
+/**
+ * @brief      build the chain of simplified levels of detail
+ */
+void Mesh::build_lod_chain() {
+    this->lods.clear();
+    this->lod_indices.clear();
+    this->lods.push_back(MeshLod(0, this->indices.size(), 0.0f));
+
+    // not worth simplifying very small meshes
+    if(this->indices.size() < 3 * 64) {
+        return;
+    }
+
+    MeshSimplifier simplifier(this->positions, this->indices);
+
+    // skinned vertices may only merge with vertices that deform identically
+    if(this->get_type() & MESH_ARMATURE) {
+        std::vector<float> influences;
+        influences.reserve(this->positions.size() * 2 * MAX_BONE_INFLUENCES);
+        for(unsigned int i=0; i<this->bone_indices.size(); i++) {
+            for(unsigned int k=0; k<MAX_BONE_INFLUENCES; k++) {
+                influences.push_back((float)this->bone_indices[i][k]);
+                influences.push_back(this->bone_weights[i][k]);
+            }
+        }
+        simplifier.set_vertex_attributes(influences, 2 * MAX_BONE_INFLUENCES);
+    }
+
+    unsigned int target = this->indices.size();
+    unsigned int previous = this->indices.size();
+    for(unsigned int i=1; i<MAX_LODS; i++) {
+        target = (target / 6) * 3;
+
+        // simplify from the full resolution mesh such that the error is measured against the original
+        float error = 0.0f;
+        const std::vector<unsigned int> lod = simplifier.simplify(this->indices, target, &error);
+
+        // stop when the reduction stalls
+        if(lod.size() == 0 || lod.size() > previous * 0.8) {
+            break;
+        }
+
+        this->lods.push_back(MeshLod(this->indices.size() + this->lod_indices.size(), lod.size(), error));
+        this->lod_indices.insert(this->lod_indices.end(), lod.begin(), lod.end());
+        previous = lod.size();
+    }
+}
+
+/**
+ * @brief      get the memory occupied by the CPU-side copy of the mesh
+ *
+ * @return     size in bytes
+ */
+size_t Mesh::get_cpu_memory() const {
+    size_t bytes = this->positions.size() * sizeof(glm::vec3) +
+                   this->normals.size() * sizeof(glm::vec3) +
+                   this->colors.size() * sizeof(glm::vec4) +
+                   this->texture_coordinates.size() * sizeof(glm::vec2) +
+                   (this->indices.size() + this->lod_indices.size()) * sizeof(unsigned int) +
+                   this->bone_indices.size() * sizeof(glm::uvec4) +
+                   this->bone_weights.size() * sizeof(glm::vec4) +
+                   this->meshlets.size() * sizeof(Meshlet);
+
+    return bytes;
+}
+
+/**
+ * @brief      free the CPU-side data that is not retained
+ */
+void Mesh::release_cpu_data() {
+    // swap with an empty vector to actually return the memory
+    if(!(this->cpu_retention & RETAIN_POSITIONS)) {
+        std::vector<glm::vec3>().swap(this->positions);
+    }
+    if(!(this->cpu_retention & RETAIN_NORMALS)) {
+        std::vector<glm::vec3>().swap(this->normals);
+    }
+    if(!(this->cpu_retention & RETAIN_COLORS)) {
+        std::vector<glm::vec4>().swap(this->colors);
+    }
+    if(!(this->cpu_retention & RETAIN_TEXTURE_COORDINATES)) {
+        std::vector<glm::vec2>().swap(this->texture_coordinates);
+    }
+    if(!(this->cpu_retention & RETAIN_INDICES)) {
+        std::vector<unsigned int>().swap(this->indices);
+        std::vector<unsigned int>().swap(this->lod_indices);
+    }
+    if(!(this->cpu_retention & RETAIN_WEIGHTS)) {
+        std::vector<glm::uvec4>().swap(this->bone_indices);
+        std::vector<glm::vec4>().swap(this->bone_weights);
     }
+
+    this->update_memory_accounting();
+}
+
+/**
+ * @brief      update the process-wide CPU memory counter for this mesh
+ */
+void Mesh::update_memory_accounting() {
+    const size_t bytes = this->get_cpu_memory();
+    total_cpu_memory += bytes;
+    total_cpu_memory -= this->accounted_cpu_memory;
+    this->accounted_cpu_memory = bytes;
 }
 
 Mesh::~Mesh() {
+    if(this->flag_loaded) {
+        glDeleteBuffers(NUM_BUFFERS, this->m_vertex_array_buffers);
+        GLState::get().forget_vertex_array(this->m_vertex_array_object);
+        glDeleteVertexArrays(1, &this->m_vertex_array_object);
+        total_gpu_memory -= this->gpu_memory;
+    }
+    total_cpu_memory -= this->accounted_cpu_memory;
+
+    for(unsigned int i=0; i<this->animation_clips.size(); i++) {
+        delete this->animation_clips[i];
+    }
+
     if(this->armature) {
         delete this->armature;
     }
 }
 
+/**
+ * @brief      build the interleaved vertex layout from the mesh type
+ */
+void Mesh::build_vertex_layout() {
+    const unsigned int type = this->get_type();
+
+    this->vertex_layout.clear();
+    this->vertex_stride = 0;
+
+    // dequantization parameters default to the identity transformation
+    this->position_offset = glm::vec3(0.0f);
+    this->position_scale = glm::vec3(1.0f);
+    this->normal_encoding = NORMAL_ENCODING_VEC3;
+
+    if(type & MESH_POSITIONS) {
+        if(this->vertex_compression & COMPRESS_POSITIONS) {
+            // normalized 16 bit integers relative to the bounding box of the mesh
+            glm::vec3 pmin = this->positions[0];
+            glm::vec3 pmax = this->positions[0];
+            for(unsigned int i=1; i<this->positions.size(); i++) {
+                pmin = glm::min(pmin, this->positions[i]);
+                pmax = glm::max(pmax, this->positions[i]);
+            }
+            this->position_offset = pmin;
+            this->position_scale = glm::max(pmax - pmin, glm::vec3(1e-6f));
+
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::POSITION, "position", 3, GL_UNSIGNED_SHORT, GL_TRUE, this->vertex_stride));
+            this->vertex_stride += 4 * sizeof(uint16_t); // pad to four components
+        } else {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::POSITION, "position", 3, GL_FLOAT, GL_FALSE, this->vertex_stride));
+            this->vertex_stride += 3 * sizeof(float);
+        }
+    }
+
+    if(type & MESH_NORMALS) {
+        if(this->vertex_compression & COMPRESS_NORMALS) {
+            // octahedral encoding in two normalized signed 16 bit integers
+            this->normal_encoding = NORMAL_ENCODING_OCTAHEDRAL;
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::NORMAL, "normal", 2, GL_SHORT, GL_TRUE, this->vertex_stride));
+            this->vertex_stride += 2 * sizeof(int16_t);
+        } else {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::NORMAL, "normal", 3, GL_FLOAT, GL_FALSE, this->vertex_stride));
+            this->vertex_stride += 3 * sizeof(float);
+        }
+    }
+
+    if(type & MESH_COLORS) {
+        if(this->vertex_compression & COMPRESS_COLORS) {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::COLOR, "color", 4, GL_UNSIGNED_BYTE, GL_TRUE, this->vertex_stride));
+            this->vertex_stride += 4 * sizeof(uint8_t);
+        } else {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::COLOR, "color", 4, GL_FLOAT, GL_FALSE, this->vertex_stride));
+            this->vertex_stride += 4 * sizeof(float);
+        }
+    }
+
+    if(type & MESH_TEXTURE_COORDINATES) {
+        // unorm16 can only represent coordinates that lie inside the texture
+        bool in_range = true;
+        for(unsigned int i=0; i<this->texture_coordinates.size() && in_range; i++) {
+            in_range = this->texture_coordinates[i].x >= 0.0f && this->texture_coordinates[i].x <= 1.0f &&
+                       this->texture_coordinates[i].y >= 0.0f && this->texture_coordinates[i].y <= 1.0f;
+        }
+
+        if((this->vertex_compression & COMPRESS_TEXTURE_COORDINATES) && in_range) {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::TEXTURE_COORDINATE, "texture_coordinate", 2, GL_UNSIGNED_SHORT, GL_TRUE, this->vertex_stride));
+            this->vertex_stride += 2 * sizeof(uint16_t);
+        } else {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::TEXTURE_COORDINATE, "texture_coordinate", 2, GL_FLOAT, GL_FALSE, this->vertex_stride));
+            this->vertex_stride += 2 * sizeof(float);
+        }
+    }
+
+    if(type & MESH_ARMATURE) {
+        // indices into the bone palette, read as integers by the shader
+        this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::BONE_INDEX, "bone_ids", MAX_BONE_INFLUENCES, GL_UNSIGNED_BYTE, GL_FALSE, this->vertex_stride, GL_TRUE));
+        this->vertex_stride += MAX_BONE_INFLUENCES * sizeof(uint8_t);
+
+        if(this->vertex_compression & COMPRESS_WEIGHTS) {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::WEIGHT, "weights", MAX_BONE_INFLUENCES, GL_UNSIGNED_BYTE, GL_TRUE, this->vertex_stride));
+            this->vertex_stride += MAX_BONE_INFLUENCES * sizeof(uint8_t);
+        } else {
+            this->vertex_layout.push_back(VertexAttribute(ShaderAttribute::WEIGHT, "weights", MAX_BONE_INFLUENCES, GL_FLOAT, GL_FALSE, this->vertex_stride));
+            this->vertex_stride += MAX_BONE_INFLUENCES * sizeof(float);
+        }
+    }
+}
+
+/**
+ * @brief      pack all vertex attributes into a single interleaved buffer
+ *
+ * @return     interleaved vertex data
+ */
+std::vector<uint8_t> Mesh::build_vertex_buffer() const {
+    const unsigned int nr_vertices = this->positions.size();
+    std::vector<uint8_t> data(nr_vertices * this->vertex_stride, 0);
+
+    for(unsigned int i=0; i<this->vertex_layout.size(); i++) {
+        const VertexAttribute& attr = this->vertex_layout[i];
+        const bool quantized = attr.format != GL_FLOAT;
+        uint8_t* dest = &data[attr.offset];
+
+        for(unsigned int j=0; j<nr_vertices; j++, dest += this->vertex_stride) {
+            switch(attr.type) {
+                case ShaderAttribute::POSITION:
+                    if(quantized) {
+                        const glm::vec3 p = (this->positions[j] - this->position_offset) / this->position_scale;
+                        for(unsigned int k=0; k<3; k++) {
+                            ((uint16_t*)dest)[k] = quantize_unorm16(p[k]);
+                        }
+                    } else {
+                        memcpy(dest, &this->positions[j][0], 3 * sizeof(float));
+                    }
+                break;
+                case ShaderAttribute::NORMAL:
+                    if(quantized) {
+                        const glm::vec2 n = encode_octahedral(this->normals[j]);
+                        ((int16_t*)dest)[0] = quantize_snorm16(n.x);
+                        ((int16_t*)dest)[1] = quantize_snorm16(n.y);
+                    } else {
+                        memcpy(dest, &this->normals[j][0], 3 * sizeof(float));
+                    }
+                break;
+                case ShaderAttribute::COLOR:
+                    if(quantized) {
+                        for(unsigned int k=0; k<4; k++) {
+                            dest[k] = quantize_unorm8(this->colors[j][k]);
+                        }
+                    } else {
+                        memcpy(dest, &this->colors[j][0], 4 * sizeof(float));
+                    }
+                break;
+                case ShaderAttribute::TEXTURE_COORDINATE:
+                    if(quantized) {
+                        ((uint16_t*)dest)[0] = quantize_unorm16(this->texture_coordinates[j].x);
+                        ((uint16_t*)dest)[1] = quantize_unorm16(this->texture_coordinates[j].y);
+                    } else {
+                        memcpy(dest, &this->texture_coordinates[j][0], 2 * sizeof(float));
+                    }
+                break;
+                case ShaderAttribute::BONE_INDEX:
+                    for(unsigned int k=0; k<MAX_BONE_INFLUENCES; k++) {
+                        dest[k] = (uint8_t)this->bone_indices[j][k];
+                    }
+                break;
+                case ShaderAttribute::WEIGHT:
+                    if(quantized) {
+                        quantize_weights(this->bone_weights[j], dest);
+                    } else {
+                        memcpy(dest, &this->bone_weights[j][0], MAX_BONE_INFLUENCES * sizeof(float));
+                    }
+                break;
+                default:
+                    // do nothing
+                break;
+            }
+        }
+    }
+
+    return data;
+}
+
+/**
+ * @brief      decode the vertices as the vertex shader receives them
+ *
+ * @param[out] _positions     dequantized positions
+ * @param[out] _normals       decoded normals
+ * @param[out] _bone_indices  bones influencing every vertex
+ * @param[out] _bone_weights  weights of these bones
+ *
+ * @return     false if the required CPU-side data is not available
+ */
+bool Mesh::decode_vertices(std::vector<glm::vec3>* _positions, std::vector<glm::vec3>* _normals,
+                           std::vector<glm::uvec4>* _bone_indices, std::vector<glm::vec4>* _bone_weights) {
+    const unsigned int nr_vertices = this->positions.size();
+    if(nr_vertices == 0 || this->normals.size() != nr_vertices ||
+       this->bone_indices.size() != nr_vertices || this->bone_weights.size() != nr_vertices) {
+        return false;
+    }
+
+    // the layout fixes the formats and dequantization parameters; it is
+    // normally only built on upload
+    if(this->vertex_layout.empty()) {
+        this->build_vertex_layout();
+    }
+
+    _positions->resize(nr_vertices);
+    _normals->resize(nr_vertices);
+    _bone_indices->resize(nr_vertices);
+    _bone_weights->resize(nr_vertices);
+
+    // round trip every attribute through its GPU format, expanding normalized
+    // integers as the GL does (c / (2^b - 1), clamped to -1 for signed values)
+    for(unsigned int i=0; i<this->vertex_layout.size(); i++) {
+        const VertexAttribute& attr = this->vertex_layout[i];
+        const bool quantized = attr.format != GL_FLOAT;
+
+        for(unsigned int j=0; j<nr_vertices; j++) {
+            switch(attr.type) {
+                case ShaderAttribute::POSITION:
+                    if(quantized) {
+                        const glm::vec3 p = (this->positions[j] - this->position_offset) / this->position_scale;
+                        glm::vec3 q;
+                        for(unsigned int k=0; k<3; k++) {
+                            q[k] = (float)quantize_unorm16(p[k]) / 65535.0f;
+                        }
+                        (*_positions)[j] = this->position_offset + q * this->position_scale;
+                    } else {
+                        (*_positions)[j] = this->position_offset + this->positions[j] * this->position_scale;
+                    }
+                break;
+                case ShaderAttribute::NORMAL:
+                    if(quantized) {
+                        const glm::vec2 n = encode_octahedral(this->normals[j]);
+                        const glm::vec2 e(std::max((float)quantize_snorm16(n.x) / 32767.0f, -1.0f),
+                                          std::max((float)quantize_snorm16(n.y) / 32767.0f, -1.0f));
+                        (*_normals)[j] = decode_octahedral(e);
+                    } else {
+                        (*_normals)[j] = this->normals[j];
+                    }
+                break;
+                case ShaderAttribute::BONE_INDEX:
+                    for(unsigned int k=0; k<MAX_BONE_INFLUENCES; k++) {
+                        (*_bone_indices)[j][k] = (uint8_t)this->bone_indices[j][k];
+                    }
+                break;
+                case ShaderAttribute::WEIGHT:
+                    if(quantized) {
+                        uint8_t q[MAX_BONE_INFLUENCES];
+                        quantize_weights(this->bone_weights[j], q);
+                        for(unsigned int k=0; k<MAX_BONE_INFLUENCES; k++) {
+                            (*_bone_weights)[j][k] = (float)q[k] / 255.0f;
+                        }
+                    } else {
+                        (*_bone_weights)[j] = this->bone_weights[j];
+                    }
+                break;
+                default:
+                    // not needed for skinning
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief      merge vertices that have identical attributes
+ */
+void Mesh::weld_vertices() {
+    const unsigned int nr_vertices = this->positions.size();
+
+    std::map<std::vector<float>, unsigned int> unique_vertices;
+    std::vector<unsigned int> remap(nr_vertices);
+    std::vector<unsigned int> kept;
+
+    for(unsigned int i=0; i<nr_vertices; i++) {
+        std::vector<float> key(&this->positions[i][0], &this->positions[i][0] + 3);
+        if(i < this->normals.size()) {
+            key.insert(key.end(), &this->normals[i][0], &this->normals[i][0] + 3);
+        }
+        if(i < this->colors.size()) {
+            key.insert(key.end(), &this->colors[i][0], &this->colors[i][0] + 4);
+        }
+        if(i < this->texture_coordinates.size()) {
+            key.insert(key.end(), &this->texture_coordinates[i][0], &this->texture_coordinates[i][0] + 2);
+        }
+        if(i < this->bone_weights.size()) {
+            for(unsigned int k=0; k<MAX_BONE_INFLUENCES; k++) {
+                key.push_back((float)this->bone_indices[i][k]);
+            }
+            key.insert(key.end(), &this->bone_weights[i][0], &this->bone_weights[i][0] + MAX_BONE_INFLUENCES);
+        }
+
+        std::map<std::vector<float>, unsigned int>::const_iterator it = unique_vertices.find(key);
+        if(it == unique_vertices.end()) {
+            remap[i] = kept.size();
+            unique_vertices[key] = kept.size();
+            kept.push_back(i);
+        } else {
+            remap[i] = it->second;
+        }
+    }
+
+    if(kept.size() == nr_vertices) {
+        return;
+    }
+
+    for(unsigned int i=0; i<this->indices.size(); i++) {
+        this->indices[i] = remap[this->indices[i]];
+    }
+
+    for(unsigned int i=0; i<kept.size(); i++) {
+        this->positions[i] = this->positions[kept[i]];
+        if(i < this->normals.size()) {
+            this->normals[i] = this->normals[kept[i]];
+        }
+        if(i < this->colors.size()) {
+            this->colors[i] = this->colors[kept[i]];
+        }
+        if(i < this->texture_coordinates.size()) {
+            this->texture_coordinates[i] = this->texture_coordinates[kept[i]];
+        }
+        if(i < this->bone_weights.size()) {
+            this->bone_indices[i] = this->bone_indices[kept[i]];
+            this->bone_weights[i] = this->bone_weights[kept[i]];
+        }
+    }
+    this->positions.resize(std::min(this->positions.size(), kept.size()));
+    this->normals.resize(std::min(this->normals.size(), kept.size()));
+    this->colors.resize(std::min(this->colors.size(), kept.size()));
+    this->texture_coordinates.resize(std::min(this->texture_coordinates.size(), kept.size()));
+    this->bone_indices.resize(std::min(this->bone_indices.size(), kept.size()));
+    this->bone_weights.resize(std::min(this->bone_weights.size(), kept.size()));
+}
+
 /**
  * @brief      load Mesh from file
  *
  * @param[in]  filename  The filename
  */
-void Mesh::load_mesh_from_file(const std::string& filename) {
-    // open file
-    if(filename.back() == 'x') {
-        this->load_mesh_from_x_file(filename);
-    } else {
-        this->load_mesh_from_obj_file(filename);
+bool Mesh::load_mesh_from_file(const std::string& filename) {
+    if(this->load_record == LoadStatistics::NO_RECORD) {
+        this->load_record = LoadStatistics::get().add_record("mesh", filename);
     }
+
+    // compiled meshes are already processed
+    if(boost::algorithm::ends_with(filename, ".imesh")) {
+        {
+            LoadTimer timer(this->load_record, LoadStatistics::PHASE_READ);
+            this->flag_failed = !this->load_mesh_from_binary_file(filename);
+        }
+        this->update_memory_accounting();
+        return !this->flag_failed;
+    }
+
+    // read the whole file first, such that reading and parsing are timed separately
+    std::stringstream contents;
+    {
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_READ);
+        std::ifstream f(filename.c_str());
+        if(!f.is_open()) {
+            std::cerr << "Could not open " << filename << std::endl;
+            this->flag_failed = true;
+            return false;
+        }
+        contents << f.rdbuf();
+    }
+    LoadStatistics::get().add_bytes_read(this->load_record, contents.tellp() > 0 ? (size_t)contents.tellp() : 0);
+
+    {
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_PARSE);
+        try {
+            if(filename.back() == 'x') {
+                this->flag_failed = !this->load_mesh_from_x_file(filename, &contents);
+            } else {
+                this->flag_failed = !this->load_mesh_from_obj_file(filename, &contents);
+            }
+        } catch(const boost::bad_lexical_cast& e) {
+            std::cerr << "Could not read a number in " << filename << std::endl;
+            this->flag_failed = true;
+        }
+    }
+
+    if(this->flag_failed) {
+        std::cerr << "Incorrect mesh file: " << filename << std::endl;
+        this->update_memory_accounting();
+        return false;
+    }
+
+    // share vertices between triangles and derive the levels of detail
+    {
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_PROCESS);
+        this->weld_vertices();
+        this->build_meshlets();
+        this->build_lod_chain();
+        this->compute_bounding_volumes();
+    }
+    this->update_memory_accounting();
+
+    return true;
 }
 
 /**
- * @brief      load Mesh from an .obj file
+ * @brief      write the processed mesh to a binary .imesh file
+ *
+ * @param[in]  filename  The filename
+ *
+ * @return     true on success
+ */
+bool Mesh::save_binary_file(const std::string& filename) const {
+    std::ofstream f(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if(!f.is_open()) {
+        std::cerr << "Unable to write mesh file: " << filename << std::endl;
+        return false;
+    }
+
+    MeshFileHeader header;
+    std::memcpy(header.magic, "IMSH", 4);
+    header.version = BINARY_FILE_VERSION;
+    header.nr_positions = this->positions.size();
+    header.nr_normals = this->normals.size();
+    header.nr_colors = this->colors.size();
+    header.nr_texture_coordinates = this->texture_coordinates.size();
+    header.nr_indices = this->indices.size();
+    header.nr_bone_indices = this->bone_indices.size();
+    header.nr_meshlets = this->meshlets.size();
+    header.nr_lods = this->lods.size();
+    header.nr_lod_indices = this->lod_indices.size();
+    header.nr_bones = this->get_bone_size();
+    header.nr_animation_clips = this->animation_clips.size();
+    header.bounding_box = this->bounding_box;
+    header.bounding_sphere = this->bounding_sphere;
+    header.pose_bounding_sphere = this->pose_bounding_sphere;
+    f.write((const char*)&header, sizeof(MeshFileHeader));
+
+    write_array(f, this->positions);
+    write_array(f, this->normals);
+    write_array(f, this->colors);
+    write_array(f, this->texture_coordinates);
+    write_array(f, this->indices);
+    write_array(f, this->bone_indices);
+    write_array(f, this->bone_weights);
+    write_array(f, this->meshlets);
+    write_array(f, this->lods);
+    write_array(f, this->lod_indices);
+
+    // bones are stored parents first, as in the armature
+    for(unsigned int i=0; i<header.nr_bones; i++) {
+        const uint32_t name_length = this->armature->get_name(i).size();
+        const int32_t parent = this->armature->get_parent(i);
+
+        f.write((const char*)&name_length, sizeof(uint32_t));
+        f.write(this->armature->get_name(i).c_str(), name_length);
+        f.write((const char*)&parent, sizeof(int32_t));
+        f.write((const char*)&this->armature->get_frame_matrix(i)[0][0], sizeof(glm::mat4));
+        f.write((const char*)&this->armature->get_offset_matrix(i)[0][0], sizeof(glm::mat4));
+    }
+
+    for(unsigned int i=0; i<header.nr_animation_clips; i++) {
+        const AnimationClip* clip = this->animation_clips[i];
+        const uint32_t counts[] = {(uint32_t)clip->get_name().size(), (uint32_t)clip->get_tracks().size(), (uint32_t)clip->get_times().size()};
+
+        f.write((const char*)counts, sizeof(counts));
+        f.write(clip->get_name().c_str(), counts[0]);
+        write_array(f, clip->get_tracks());
+        write_array(f, clip->get_times());
+        write_array(f, clip->get_values());
+    }
+
+    return f.good();
+}
+
+/**
+ * @brief      check whether a binary .imesh file has the current format
  *
  * @param[in]  filename  The filename
+ *
+ * @return     true if the file exists and matches BINARY_FILE_VERSION
  */
-void Mesh::load_mesh_from_obj_file(const std::string& filename) {
-    // open file
-    std::ifstream f;
-    f.open(filename.c_str());
+bool Mesh::is_binary_file_current(const std::string& filename) {
+    std::ifstream f(filename.c_str(), std::ios::binary);
+
+    MeshFileHeader header;
+    if(!f.read((char*)&header, sizeof(MeshFileHeader))) {
+        return false;
+    }
+
+    return std::memcmp(header.magic, "IMSH", 4) == 0 && header.version == BINARY_FILE_VERSION;
+}
+
+/**
+ * @brief      load Mesh from a binary .imesh file
+ *
+ * @param[in]  filename  The filename
+ */
+bool Mesh::load_mesh_from_binary_file(const std::string& filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(MeshFileHeader)) {
+        std::cerr << "Could not open " << filename << std::endl;
+        if(fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        std::cerr << "Could not map " << filename << std::endl;
+        return false;
+    }
+
+    const uint8_t* ptr = (const uint8_t*)data;
+    const uint8_t* end = ptr + st.st_size;
+
+    MeshFileHeader header;
+    std::memcpy(&header, ptr, sizeof(MeshFileHeader));
+    ptr += sizeof(MeshFileHeader);
+
+    bool valid = std::memcmp(header.magic, "IMSH", 4) == 0 && header.version == BINARY_FILE_VERSION;
+    valid = valid && read_array(&ptr, end, header.nr_positions, &this->positions);
+    valid = valid && read_array(&ptr, end, header.nr_normals, &this->normals);
+    valid = valid && read_array(&ptr, end, header.nr_colors, &this->colors);
+    valid = valid && read_array(&ptr, end, header.nr_texture_coordinates, &this->texture_coordinates);
+    valid = valid && read_array(&ptr, end, header.nr_indices, &this->indices);
+    valid = valid && read_array(&ptr, end, header.nr_bone_indices, &this->bone_indices);
+    valid = valid && read_array(&ptr, end, header.nr_bone_indices, &this->bone_weights);
+    valid = valid && read_array(&ptr, end, header.nr_meshlets, &this->meshlets);
+    valid = valid && read_array(&ptr, end, header.nr_lods, &this->lods);
+    valid = valid && read_array(&ptr, end, header.nr_lod_indices, &this->lod_indices);
+
+    if(valid && header.nr_bones > 0) {
+        this->armature = new Armature();
+        for(unsigned int i=0; i<header.nr_bones && valid; i++) {
+            uint32_t name_length = 0;
+            int32_t parent = -1;
+            glm::mat4 matrices[2];
+
+            valid = (end - ptr) >= (ptrdiff_t)sizeof(uint32_t);
+            if(valid) {
+                std::memcpy(&name_length, ptr, sizeof(uint32_t));
+                ptr += sizeof(uint32_t);
+                valid = (end - ptr) >= (ptrdiff_t)(name_length + sizeof(int32_t) + sizeof(matrices));
+            }
+            if(!valid) {
+                break;
+            }
+
+            const std::string name((const char*)ptr, name_length);
+            ptr += name_length;
+            std::memcpy(&parent, ptr, sizeof(int32_t));
+            ptr += sizeof(int32_t);
+            std::memcpy(&matrices[0][0][0], ptr, sizeof(matrices));
+            ptr += sizeof(matrices);
+
+            // the matrices are stored as used by the armature
+            const unsigned int bone_id = this->armature->add_bone(matrices[0], name, ((unsigned int)parent < i) ? parent : -1);
+            this->armature->set_offset_matrix(bone_id, matrices[1]);
+        }
+    }
+
+    for(unsigned int i=0; i<header.nr_animation_clips && valid && this->armature; i++) {
+        uint32_t counts[3];
+        valid = (end - ptr) >= (ptrdiff_t)sizeof(counts);
+        if(valid) {
+            std::memcpy(counts, ptr, sizeof(counts));
+            ptr += sizeof(counts);
+            valid = (end - ptr) >= (ptrdiff_t)counts[0];
+        }
+        if(!valid) {
+            break;
+        }
+
+        const std::string name((const char*)ptr, counts[0]);
+        ptr += counts[0];
+
+        std::vector<AnimationTrack> tracks;
+        std::vector<float> times;
+        std::vector<glm::vec4> values;
+        valid = read_array(&ptr, end, counts[1], &tracks);
+        valid = valid && read_array(&ptr, end, counts[2], &times);
+        valid = valid && read_array(&ptr, end, counts[2], &values);
+
+        if(valid) {
+            this->animation_clips.push_back(new AnimationClip(name, tracks, times, values));
+            this->animation_clips.back()->bind(this->armature);
+        }
+    }
 
+    munmap(data, st.st_size);
+    LoadStatistics::get().add_bytes_read(this->load_record, st.st_size);
+
+    if(!valid) {
+        std::cerr << "Corrupt or outdated mesh file: " << filename << std::endl;
+
+        // drop whatever was read, such that the source can be loaded instead
+        std::vector<glm::vec3>().swap(this->positions);
+        std::vector<glm::vec3>().swap(this->normals);
+        std::vector<glm::vec4>().swap(this->colors);
+        std::vector<glm::vec2>().swap(this->texture_coordinates);
+        std::vector<unsigned int>().swap(this->indices);
+        std::vector<glm::uvec4>().swap(this->bone_indices);
+        std::vector<glm::vec4>().swap(this->bone_weights);
+        std::vector<Meshlet>().swap(this->meshlets);
+        std::vector<MeshLod>().swap(this->lods);
+        std::vector<unsigned int>().swap(this->lod_indices);
+        for(unsigned int i=0; i<this->animation_clips.size(); i++) {
+            delete this->animation_clips[i];
+        }
+        this->animation_clips.clear();
+        delete this->armature;
+        this->armature = NULL;
+
+        return false;
+    }
+
+    this->bounding_box = header.bounding_box;
+    this->bounding_sphere = header.bounding_sphere;
+    this->pose_bounding_sphere = header.pose_bounding_sphere;
+
+    return true;
+}
+
+/**
+ * @brief      load Mesh from an .obj file
+ *
+ * @param[in]  filename  The filename
+ * @param      f         contents of the file
+ */
+bool Mesh::load_mesh_from_obj_file(const std::string& filename, std::istream* f) {
     boost::regex v_line("v\\s+([0-9.-]+)\\s+([0-9.-]+)\\s+([0-9.-]+).*");
     boost::regex vt_line("vt\\s+([0-9.-]+)\\s+([0-9.-]+).*");
     boost::regex vn_line("vn\\s+([0-9.-]+)\\s+([0-9.-]+)\\s+([0-9.-]+).*");
@@ -310,7 +1434,7 @@ void Mesh::load_mesh_from_obj_file(const std::string& filename) {
     std::vector<unsigned int> _normal_indices;
 
     std::string line;
-    while(getline(f, line)) {
+    while(getline(*f, line)) {
         boost::smatch what1;
 
         if (boost::regex_match(line, what1, v_line)) {
@@ -376,18 +1500,22 @@ void Mesh::load_mesh_from_obj_file(const std::string& filename) {
             this->normals.push_back(_normal_coordinates[_normal_indices[i]]);
         }
     }
+
+    if(this->indices.empty()) {
+        std::cerr << "No faces found in " << filename << std::endl;
+        return false;
+    }
+
+    return true;
 }
 
 /**
  * @brief      load Mesh from an .x file
  *
  * @param[in]  filename  The filename
+ * @param      f         contents of the file
  */
-void Mesh::load_mesh_from_x_file(const std::string& filename) {
-     // open file
-    std::ifstream f;
-    f.open(filename.c_str());
-
+bool Mesh::load_mesh_from_x_file(const std::string& filename, std::istream* f) {
     unsigned int reading_state          = 0x00000000;
     const unsigned int rs_bones         = 1 << 0;
     const unsigned int rs_mesh          = 1 << 1;
@@ -403,9 +1531,7 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
     std::vector<unsigned int> _texture_indices;
     std::vector<unsigned int> _normal_indices;
 
-    std::vector<std::vector<float>> _weights;
-    std::vector<glm::mat4> _offset_matrices;
-    std::vector<std::string> bone_names;
+    std::vector<std::vector<std::pair<float, unsigned int> > > _influences;    // (weight, bone) per vertex
 
     boost::regex regex_open_frame("^\\s*Frame Armature_([A-Za-z_0-9]+) \\{");
     boost::regex regex_close_frame("^\\s*\\}.*");
@@ -416,34 +1542,140 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
     boost::regex regex_bone_name("^\\s*\\\"Armature_([A-Za-z_0-9]+)\\\";");
     boost::regex regex_number("^\\s*([0-9]+)[;,]");
     boost::regex regex_value("^\\s*([0-9.-]+)[;,]");
+    boost::regex regex_ticks_per_second("^\\s*AnimTicksPerSecond\\s*\\{\\s*(?:([0-9]+);)?.*");
+    boost::regex regex_animation_set("^\\s*AnimationSet\\s*([A-Za-z_0-9]*)\\s*\\{.*");
+    boost::regex regex_animation_bone("^\\s*\\{\\s*Armature_([A-Za-z_0-9]+)\\s*\\}.*");
+    boost::regex regex_animation_key("^\\s*AnimationKey\\s*[A-Za-z_0-9]*\\s*\\{.*");
+    boost::regex regex_key("^\\s*([0-9]+);\\s*([0-9]+);([0-9eE.,\\s-]+);;[,;]*\\s*");
 
     unsigned int level = 0;
-    const Bone* bone_ptr = NULL;
+    int frame_bone = -1;
+    int animation_bone = -1;
+    float ticks_per_second = 4800.0f;   // default of the .x format
+
+    // the .x file stores column vectors in a z-up frame; the armature uses row vectors
+    static const glm::mat4 T0_inv = glm::inverse(glm::rotate(glm::mat4(1.0), -(float)M_PI / 2.0f, glm::vec3(1,0,0)));
+    static const glm::mat4 T0 = glm::inverse(T0_inv);
 
     this->armature = new Armature();
     reading_state |= rs_bones;
     reading_state |= rs_mesh;
 
     std::string line;
-    while(getline(f, line)) {
+    while(getline(*f, line)) {
         boost::smatch what1;
 
+        //****************
+        // ANIMATIONS
+        //****************
+        if (boost::regex_match(line, what1, regex_ticks_per_second)) {
+            if(!what1[1].matched) {
+                getline(*f, line);
+                boost::regex_match(line, what1, regex_number);
+            }
+            ticks_per_second = boost::lexical_cast<float>(what1[1]);
+            continue;
+        }
+
+        if (boost::regex_match(line, what1, regex_animation_set)) {
+            this->animation_clips.push_back(new AnimationClip(what1[1]));
+            continue;
+        }
+
+        if (boost::regex_match(line, what1, regex_animation_bone)) {
+            animation_bone = this->armature->find_bone_by_name(what1[1]);
+            continue;
+        }
+
+        if (boost::regex_match(line, what1, regex_animation_key)) {
+            if(this->animation_clips.empty() || animation_bone < 0) {
+                std::cerr << "Animation key outside of an animation of a bone in " << filename << std::endl;
+                return false;
+            }
+
+            boost::smatch what2;
+            getline(*f, line); // read key type
+            boost::regex_match(line, what2, regex_number);
+            const unsigned int key_type = boost::lexical_cast<unsigned int>(what2[1]);
+
+            getline(*f, line); // read number of keys
+            boost::regex_match(line, what2, regex_number);
+            const unsigned int nr_keys = boost::lexical_cast<unsigned int>(what2[1]);
+
+            // keys are converted to the space of the armature, as the offset matrices
+            std::vector<float> key_times;
+            std::vector<glm::vec4> rotations, positions, scales;
+            for(unsigned int i=0; i<nr_keys; i++) {
+                getline(*f, line);
+                std::vector<std::string> pieces;
+                if(boost::regex_match(line, what2, regex_key)) {
+                    const std::string values = what2[3];
+                    boost::split(pieces, values, boost::is_any_of(","));
+                }
+                if(pieces.empty() || pieces.size() != boost::lexical_cast<unsigned int>(what2[2])) {
+                    std::cerr << "Could not read animation key: " << line << std::endl;
+                    return false;
+                }
+
+                std::vector<float> v;
+                for(unsigned int j=0; j<pieces.size(); j++) {
+                    v.push_back(boost::lexical_cast<float>(boost::trim_copy(pieces[j])));
+                }
+                key_times.push_back(boost::lexical_cast<float>(what2[1]) / ticks_per_second);
+
+                if(key_type == 0 && v.size() == 4) {
+                    const glm::mat3 rotation = glm::mat3(T0_inv) * glm::mat3_cast(glm::quat(v[0], v[1], v[2], v[3])) * glm::mat3(T0);
+                    const glm::quat q = glm::quat_cast(rotation);
+                    rotations.push_back(glm::vec4(q.x, q.y, q.z, q.w));
+                } else if(key_type == 1 && v.size() == 3) {
+                    // T0 is a quarter turn, such that the axes of the scale only swap
+                    scales.push_back(glm::vec4(glm::abs(glm::mat3(T0_inv) * glm::vec3(v[0], v[1], v[2])), 0.0f));
+                } else if(key_type == 2 && v.size() == 3) {
+                    positions.push_back(glm::vec4(glm::mat3(T0_inv) * glm::vec3(v[0], v[1], v[2]), 0.0f));
+                } else if((key_type == 3 || key_type == 4) && v.size() == 16) {
+                    glm::mat4 key;
+                    for(unsigned int j=0; j<16; j++) {
+                        key[j / 4][j % 4] = v[j];
+                    }
+                    rotations.push_back(glm::vec4());
+                    positions.push_back(glm::vec4());
+                    scales.push_back(glm::vec4());
+                    AnimationClip::decompose(T0_inv * key * T0, &rotations.back(), &positions.back(), &scales.back());
+                } else {
+                    std::cerr << "Unsupported animation key of type " << key_type << " in " << filename << std::endl;
+                    return false;
+                }
+            }
+
+            AnimationClip* clip = this->animation_clips.back();
+            if(!rotations.empty()) {
+                clip->add_channel(animation_bone, AnimationClip::CHANNEL_ROTATION, key_times, rotations);
+            }
+            if(!positions.empty()) {
+                clip->add_channel(animation_bone, AnimationClip::CHANNEL_POSITION, key_times, positions);
+            }
+            if(!scales.empty()) {
+                clip->add_channel(animation_bone, AnimationClip::CHANNEL_SCALE, key_times, scales);
+            }
+            continue;
+        }
+
         // look for occurrences of Frame
         if(reading_state & rs_bones) {
             if (boost::regex_match(line, what1, regex_open_frame)) {
                 level++;
-                glm::mat4 mat = this->read_frame_transform_matrix(&f);
+                glm::mat4 mat = this->read_frame_transform_matrix(f);
 
                 // root bone encountered
                 if(level > 0) {
-                    bone_ptr = this->armature->add_bone(mat, what1[1], bone_ptr);
+                    frame_bone = this->armature->add_bone(glm::transpose(mat), what1[1], frame_bone);
                 }
                 continue;
             }
             if (boost::regex_match(line, what1, regex_close_frame)) {
                 if(level > 0) {
                     level--;
-                    bone_ptr = bone_ptr->get_parent();
+                    frame_bone = (frame_bone >= 0) ? this->armature->get_parent(frame_bone) : -1;
                 }
                 continue;
             }
@@ -457,13 +1689,13 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
                 reading_state &= ~rs_bones;
                 reading_state &= ~rs_mesh;
 
-                getline(f, line); // read number of vertices
+                getline(*f, line); // read number of vertices
                 boost::regex_match(line, what1, regex_number);
                 const unsigned int nr_vertices = boost::lexical_cast<unsigned int>(what1[1]);
 
                 boost::regex regex_vec3("^\\s*([0-9.-]+)[ ;]+([0-9.-]+)[ ;]+([0-9.-]+)[ ;,]+");
                 for(unsigned int i=0; i<nr_vertices; i++) {
-                    getline(f, line);
+                    getline(*f, line);
                     boost::smatch what2;
                     if(boost::regex_match(line, what2, regex_vec3)) {
                         _positions.push_back(glm::vec3(boost::lexical_cast<float>(what2[1]),
@@ -473,11 +1705,11 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
                                             );
                     }
                 }
-                getline(f, line);
+                getline(*f, line);
                 boost::regex_match(line, what1, regex_number);
                 const unsigned int nr_indices = boost::lexical_cast<unsigned int>(what1[1]);
                 for(unsigned int i=0; i<nr_indices; i++) {
-                    getline(f, line);
+                    getline(*f, line);
                     boost::trim(line);
                     std::vector<std::string> pieces;
                     boost::split(pieces, line, boost::is_any_of(",;"), boost::token_compress_on);
@@ -498,13 +1730,13 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
             if (boost::regex_search(line, regex_normals)) {
                 reading_state &= ~rs_normals;
 
-                getline(f, line); // read number of vertices
+                getline(*f, line); // read number of vertices
                 boost::regex_match(line, what1, regex_number);
                 const unsigned int nr_vertices = boost::lexical_cast<unsigned int>(what1[1]);
 
                 boost::regex regex_vec3("^\\s*([0-9.-]+)[ ;]+([0-9.-]+)[ ;]+([0-9.-]+)[ ;,]+");
                 for(unsigned int i=0; i<nr_vertices; i++) {
-                    getline(f, line);
+                    getline(*f, line);
                     boost::smatch what2;
                     if(boost::regex_match(line, what2, regex_vec3)) {
                         _normal_coordinates.push_back(glm::vec3(boost::lexical_cast<float>(what2[1]),
@@ -514,11 +1746,11 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
                                             );
                     }
                 }
-                getline(f, line);
+                getline(*f, line);
                 boost::regex_match(line, what1, regex_number);
                 const unsigned int nr_indices = boost::lexical_cast<unsigned int>(what1[1]);
                 for(unsigned int i=0; i<nr_indices; i++) {
-                    getline(f, line);
+                    getline(*f, line);
                     boost::trim(line);
                     std::vector<std::string> pieces;
                     boost::split(pieces, line, boost::is_any_of(",;"), boost::token_compress_on);
@@ -529,7 +1761,7 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
                 }
             }
             // discard line
-            getline(f, line);
+            getline(*f, line);
 
             reading_state |= rs_textures;
             continue;
@@ -542,13 +1774,13 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
             if (boost::regex_search(line, regex_textures)) {
                 reading_state &= ~rs_textures;
 
-                getline(f, line); // read number of vertices
+                getline(*f, line); // read number of vertices
                 boost::regex_match(line, what1, regex_number);
                 const unsigned int nr_vertices = boost::lexical_cast<unsigned int>(what1[1]);
 
                 boost::regex regex_vec2("^\\s*([0-9.-]+)[ ;]+([0-9.-]+)[ ;,]+");
                 for(unsigned int i=0; i<nr_vertices; i++) {
-                    getline(f, line);
+                    getline(*f, line);
                     boost::smatch what2;
                     if(boost::regex_match(line, what2, regex_vec2)) {
                         _texture_coordinates.push_back(glm::vec2(boost::lexical_cast<float>(what2[1]),
@@ -571,12 +1803,12 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
             if (boost::regex_match(line, what1, regex_skinweight)) {
                 boost::smatch what2;
 
-                getline(f, line); // read bone name
+                getline(*f, line); // read bone name
                 boost::regex_match(line, what2, regex_bone_name);
                 std::string name = what2[1];
-                bone_names.push_back(name);
+                const unsigned int bone_id = this->armature->find_bone_by_name(name);
 
-                getline(f, line); // read number of vertices
+                getline(*f, line); // read number of vertices
                 boost::regex_match(line, what2, regex_number);
                 const unsigned int nr_vertices = boost::lexical_cast<unsigned int>(what2[1]);
 
@@ -584,34 +1816,50 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
                 std::vector<float> weights(nr_vertices, 0.0f);
 
                 for(unsigned int i=0; i<nr_vertices; i++) {
-                    getline(f, line);
+                    getline(*f, line);
                     if(boost::regex_match(line, what2, regex_number)) {
                         idx[i] = boost::lexical_cast<unsigned int>(what2[1]);
                     }
                 }
                 for(unsigned int i=0; i<nr_vertices; i++) {
-                    getline(f, line);
+                    getline(*f, line);
                     if(boost::regex_match(line, what2, regex_value)) {
                         weights[i] = boost::lexical_cast<float>(what2[1]);
                     }
                 }
 
-                _offset_matrices.push_back(this->read_matrix(&f));
+                this->armature->set_offset_matrix(bone_id, glm::transpose(T0_inv * this->read_matrix(f)));
 
-                // collect
-                _weights.push_back(std::vector<float>(_positions.size(), 0.0f));
+                // collect the influences of this bone
+                _influences.resize(_positions.size());
                 for(unsigned int i=0; i<nr_vertices; i++) {
-                    _weights.back()[idx[i]] = weights[i];
+                    if(weights[i] > 0.0f) {
+                        _influences[idx[i]].push_back(std::make_pair(weights[i], bone_id));
+                    }
                 }
             }
         }
 
     }
 
-    // also rebuild weights vectors
-    std::vector<std::vector<float>> weights_rebuild;
-    for(unsigned int i=0; i<_offset_matrices.size(); i++) {
-        weights_rebuild.push_back(std::vector<float>(_position_indices.size(), 0.0));
+    // keep the strongest influences of every vertex and renormalize them
+    std::vector<glm::uvec4> _bone_indices(_influences.size());
+    std::vector<glm::vec4> _bone_weights(_influences.size());
+    for(unsigned int i=0; i<_influences.size(); i++) {
+        std::vector<std::pair<float, unsigned int> >& influences = _influences[i];
+        std::sort(influences.begin(), influences.end(), [](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+
+        float sum = 0.0f;
+        for(unsigned int k=0; k<influences.size() && k<MAX_BONE_INFLUENCES; k++) {
+            sum += influences[k].first;
+        }
+
+        for(unsigned int k=0; k<influences.size() && k<MAX_BONE_INFLUENCES && sum > 0.0f; k++) {
+            _bone_indices[i][k] = influences[k].second;
+            _bone_weights[i][k] = influences[k].first / sum;
+        }
     }
 
     // process all results
@@ -624,29 +1872,36 @@ void Mesh::load_mesh_from_x_file(const std::string& filename) {
             this->texture_coordinates.back()[1] = 1.0f - this->texture_coordinates.back()[1];
             this->normals.push_back(_normal_coordinates[_normal_indices[i]]);
 
-            // also rebuild weights
-            for(unsigned int j=0; j<_offset_matrices.size(); j++) {
-                weights_rebuild[j][i] = _weights[j][_position_indices[i]];
+            if(!_influences.empty()) {
+                this->bone_indices.push_back(_bone_indices[_position_indices[i]]);
+                this->bone_weights.push_back(_bone_weights[_position_indices[i]]);
             }
         }
     }
 
-    for(unsigned int i=0; i<_offset_matrices.size(); i++) {
-        const unsigned int bone_id = this->armature->find_bone_by_name(bone_names[i]);
+    // the frames follow from the offset matrices
+    this->armature->build_frame_matrices();
 
-        this->armature->get_bone_by_idx(bone_id)->set_offset_matrix(_offset_matrices[i]);
-        this->armature->get_bone_by_idx(bone_id)->set_weights(weights_rebuild[i]);
+    for(unsigned int i=0; i<this->animation_clips.size(); i++) {
+        this->animation_clips[i]->bind(this->armature);
     }
+
+    if(this->armature->get_nr_bones() > Armature::MAX_BONES) {
+        std::cerr << "Armature of " << filename << " exceeds the bone palette (" << Armature::MAX_BONES << " bones)." << std::endl;
+        return false;
+    }
+
+    return true;
 }
 
 /**
- * @brief      read frame transform matrix from ifstream
+ * @brief      read frame transform matrix from a stream
  *
- * @param      f     ifstream pointer
+ * @param      f     stream pointer
  *
  * @return     matrix
  */
-glm::mat4 Mesh::read_frame_transform_matrix(std::ifstream* f) {
+glm::mat4 Mesh::read_frame_transform_matrix(std::istream* f) {
     std::string line;
 
     // skip first line
@@ -662,13 +1917,13 @@ glm::mat4 Mesh::read_frame_transform_matrix(std::ifstream* f) {
 }
 
 /**
- * @brief      read matrix from ifstream
+ * @brief      read matrix from a stream
  *
- * @param      f     ifstream pointer
+ * @param      f     stream pointer
  *
  * @return     matrix
  */
-glm::mat4 Mesh::read_matrix(std::ifstream* f) {
+glm::mat4 Mesh::read_matrix(std::istream* f) {
     glm::mat4 mat;
     boost::regex regex_frame_transform_matrix("^\\s*([0-9.-]+),\\s?([0-9.-]+),\\s?([0-9.-]+),\\s?([0-9.-]+)[,;]+");
     boost::smatch what1;
@@ -689,3 +1944,176 @@ glm::mat4 Mesh::read_matrix(std::ifstream* f) {
 
     return mat;
 }
+
+static uint16_t quantize_unorm16(float v) {
+    return (uint16_t)(std::min(std::max(v, 0.0f), 1.0f) * 65535.0f + 0.5f);
+}
+
+static int16_t quantize_snorm16(float v) {
+    return (int16_t)std::floor(std::min(std::max(v, -1.0f), 1.0f) * 32767.0f + 0.5f);
+}
+
+static uint8_t quantize_unorm8(float v) {
+    return (uint8_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+static void quantize_weights(const glm::vec4& w, uint8_t* q) {
+    int sum = 0;
+    unsigned int largest = 0;
+    for(unsigned int k=0; k<Mesh::MAX_BONE_INFLUENCES; k++) {
+        q[k] = quantize_unorm8(w[k]);
+        sum += q[k];
+        if(q[k] > q[largest]) {
+            largest = k;
+        }
+    }
+
+    // rounding every weight on its own scales the vertex; the largest weight takes up the remainder
+    if(sum > 0) {
+        q[largest] = (uint8_t)std::min(std::max((int)q[largest] + 255 - sum, 0), 255);
+    }
+}
+
+static glm::vec2 encode_octahedral(const glm::vec3& n) {
+    const float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    glm::vec2 e(n.x / l1, n.y / l1);
+
+    // fold the lower hemisphere over the diagonals
+    if(n.z < 0.0f) {
+        const glm::vec2 f(1.0f - std::fabs(e.y), 1.0f - std::fabs(e.x));
+        e.x = e.x >= 0.0f ? f.x : -f.x;
+        e.y = e.y >= 0.0f ? f.y : -f.y;
+    }
+
+    return e;
+}
+
+static glm::vec3 decode_octahedral(const glm::vec2& e) {
+    glm::vec3 v(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+    const float t = std::max(-v.z, 0.0f);
+    v.x += v.x >= 0.0f ? -t : t;
+    v.y += v.y >= 0.0f ? -t : t;
+    return v * (1.0f / std::sqrt(glm::dot(v, v)));
+}
+
+static BoundingSphere minimum_bounding_sphere(std::vector<glm::vec3> points) {
+    if(points.empty()) {
+        return BoundingSphere();
+    }
+
+    // randomized incremental construction has an expected linear running time
+    std::minstd_rand rng(0x15a4a);
+    std::shuffle(points.begin(), points.end(), rng);
+
+    // small slack avoids endless updates due to rounding
+    const float eps = 1e-5f;
+    BoundingSphere s(points[0], 0.0f);
+    const auto outside = [&s, eps](const glm::vec3& p) {
+        return glm::length(p - s.center) > s.radius * (1.0f + eps) + eps;
+    };
+
+    glm::vec3 support[4];
+    for(unsigned int i=1; i<points.size(); i++) {
+        if(!outside(points[i])) {
+            continue;
+        }
+        support[0] = points[i];
+        s = BoundingSphere(points[i], 0.0f);
+        for(unsigned int j=0; j<i; j++) {
+            if(!outside(points[j])) {
+                continue;
+            }
+            support[1] = points[j];
+            s = circumscribed_sphere(support, 2);
+            for(unsigned int k=0; k<j; k++) {
+                if(!outside(points[k])) {
+                    continue;
+                }
+                support[2] = points[k];
+                s = circumscribed_sphere(support, 3);
+                for(unsigned int l=0; l<k; l++) {
+                    if(!outside(points[l])) {
+                        continue;
+                    }
+                    support[3] = points[l];
+                    s = circumscribed_sphere(support, 4);
+                }
+            }
+        }
+    }
+
+    s.radius *= (1.0f + eps);
+    return s;
+}
+
+static BoundingSphere circumscribed_sphere(const glm::vec3* p, unsigned int n) {
+    // fall back to the sphere through the two furthest points for degenerate sets
+    BoundingSphere fallback(p[0], 0.0f);
+    for(unsigned int i=0; i<n; i++) {
+        for(unsigned int j=i+1; j<n; j++) {
+            const float r = 0.5f * glm::length(p[j] - p[i]);
+            if(r > fallback.radius) {
+                fallback = BoundingSphere((p[i] + p[j]) * 0.5f, r);
+            }
+        }
+    }
+
+    if(n < 3) {
+        return fallback;
+    }
+
+    const glm::vec3 ab = p[1] - p[0];
+    const glm::vec3 ac = p[2] - p[0];
+    const glm::vec3 nrm = glm::cross(ab, ac);
+    const float nrm2 = glm::dot(nrm, nrm);
+
+    if(nrm2 < 1e-12f) {
+        return fallback;
+    }
+
+    glm::vec3 center;
+    if(n == 3) {
+        center = p[0] + (glm::cross(nrm, ab) * glm::dot(ac, ac) + glm::cross(ac, nrm) * glm::dot(ab, ab)) / (2.0f * nrm2);
+    } else {
+        // solve 2 (p_i - p_0) . x = |p_i - p_0|^2 for the center relative to p_0
+        const glm::vec3 ad = p[3] - p[0];
+        const float det = 2.0f * glm::dot(ab, glm::cross(ac, ad));
+        if(std::fabs(det) < 1e-12f) {
+            return fallback;
+        }
+        center = p[0] + (glm::cross(ac, ad) * glm::dot(ab, ab) +
+                         glm::cross(ad, ab) * glm::dot(ac, ac) +
+                         glm::cross(ab, ac) * glm::dot(ad, ad)) / det;
+    }
+
+    float radius = 0.0f;
+    for(unsigned int i=0; i<n; i++) {
+        radius = std::max(radius, glm::length(p[i] - center));
+    }
+
+    return BoundingSphere(center, radius);
+}
+
+template <typename T> static void write_array(std::ofstream& f, const std::vector<T>& v) {
+    if(!v.empty()) {
+        f.write((const char*)&v[0], v.size() * sizeof(T));
+    }
+}
+
+template <typename T> static bool read_array(const uint8_t** ptr, const uint8_t* end, unsigned int n, std::vector<T>* v) {
+    const size_t bytes = (size_t)n * sizeof(T);
+    if((size_t)(end - *ptr) < bytes) {
+        return false;
+    }
+
+    // elements need not be default constructible (e.g. MeshLod)
+    v->clear();
+    v->reserve(n);
+    for(unsigned int i=0; i<n; i++) {
+        T element = *(const T*)(*ptr + i * sizeof(T));
+        v->push_back(element);
+    }
+    *ptr += bytes;
+
+    return true;
+}
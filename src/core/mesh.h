@@ -22,9 +22,17 @@
 #define _MESH_H
 
 #include <vector>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -37,27 +45,163 @@
 #include <boost/algorithm/string.hpp>
 
 #include "core/armature.h"
+#include "core/animation.h"
+#include "core/shader.h"
+#include "core/gl_state.h"
+#include "core/mesh_simplifier.h"
+#include "core/frustum.h"
+#include "core/load_statistics.h"
+
+/**
+ * @brief      description of a single attribute inside the interleaved vertex buffer
+ */
+struct VertexAttribute {
+    unsigned int type;          //!< attribute type (see ShaderAttribute)
+    std::string name;           //!< name of the attribute in the shader
+    GLint components;           //!< number of components
+    GLenum format;              //!< data type of a single component
+    GLboolean normalized;       //!< whether fixed-point data is normalized
+    unsigned int offset;        //!< byte offset of the attribute within a vertex
+    GLboolean integer;          //!< whether the shader reads the attribute as integers
+
+    VertexAttribute(unsigned int _type, const std::string& _name, GLint _components,
+                    GLenum _format, GLboolean _normalized, unsigned int _offset,
+                    GLboolean _integer = GL_FALSE) :
+        type(_type),
+        name(_name),
+        components(_components),
+        format(_format),
+        normalized(_normalized),
+        offset(_offset),
+        integer(_integer) {}
+};
+
+/**
+ * @brief      range of the element buffer describing a single level of detail
+ */
+struct MeshLod {
+    unsigned int offset;        //!< index of the first element
+    unsigned int count;         //!< number of elements
+    float error;                //!< geometric error in model units
+
+    MeshLod(unsigned int _offset, unsigned int _count, float _error) :
+        offset(_offset),
+        count(_count),
+        error(_error) {}
+};
+
+/**
+ * @brief      small cluster of triangles that is culled as a whole
+ */
+struct Meshlet {
+    unsigned int offset;        //!< index of the first element
+    unsigned int count;         //!< number of elements
+    glm::vec3 center;           //!< center of the bounding sphere
+    float radius;               //!< radius of the bounding sphere
+    glm::vec3 cone_axis;        //!< average normal of the triangles
+    float cone_cutoff;          //!< sine of the normal cone angle (1 disables backface culling)
+    int bone;                   //!< bone moving the cluster rigidly (or MESHLET_STATIC / MESHLET_DEFORMING)
+
+    Meshlet() :
+        offset(0),
+        count(0),
+        center(0.0f),
+        radius(0.0f),
+        cone_axis(0.0f, 0.0f, 1.0f),
+        cone_cutoff(1.0f),
+        bone(-1) {}
+};
+
+/**
+ * @brief      axis-aligned bounding box
+ */
+struct BoundingBox {
+    glm::vec3 min;              //!< lower corner
+    glm::vec3 max;              //!< upper corner
+
+    BoundingBox() :
+        min(0.0f),
+        max(0.0f) {}
+
+    BoundingBox(const glm::vec3& _min, const glm::vec3& _max) :
+        min(_min),
+        max(_max) {}
+
+    inline glm::vec3 center() const {
+        return (this->min + this->max) * 0.5f;
+    }
+
+    inline glm::vec3 extent() const {
+        return (this->max - this->min) * 0.5f;
+    }
+};
+
+/**
+ * @brief      bounding sphere
+ */
+struct BoundingSphere {
+    glm::vec3 center;           //!< center of the sphere
+    float radius;               //!< radius of the sphere
+
+    BoundingSphere() :
+        center(0.0f),
+        radius(0.0f) {}
+
+    BoundingSphere(const glm::vec3& _center, float _radius) :
+        center(_center),
+        radius(_radius) {}
+};
 
 class Mesh {
 private:
     Armature* armature;                                 //!< pointer to armature class
+    std::vector<AnimationClip*> animation_clips;        //!< keyframe animations of the armature
     std::vector<glm::vec3> positions;                   //!< vector holding positions
     std::vector<glm::vec3> normals;                     //!< vector holding vertex normals
     std::vector<glm::vec4> colors;                      //!< vector holding colors
     std::vector<glm::vec2> texture_coordinates;         //!< vector holding texture coordinates
     std::vector<unsigned int> indices;                  //!< vector holding set of indices
+    std::vector<glm::uvec4> bone_indices;               //!< bones influencing every vertex (see MAX_BONE_INFLUENCES)
+    std::vector<glm::vec4> bone_weights;                //!< normalized weights of these bones
+
+    BoundingBox bounding_box;                           //!< bounds of the rest pose
+    BoundingSphere bounding_sphere;                     //!< smallest sphere enclosing the rest pose
+    BoundingSphere pose_bounding_sphere;                //!< sphere enclosing every pose of the armature
+
+    std::vector<Meshlet> meshlets;                      //!< clusters of the full resolution level of detail
+    std::vector<MeshLod> lods;                          //!< levels of detail, from fine to coarse
+    std::vector<unsigned int> lod_indices;              //!< indices of the simplified levels of detail
+
+    std::vector<VertexAttribute> vertex_layout;         //!< layout of a vertex in the interleaved buffer
+    unsigned int vertex_stride;                         //!< size of a single vertex in bytes
+
+    unsigned int vertex_compression;                    //!< compact formats used on the GPU (COMPRESS_* bits)
+    glm::vec3 position_offset;                          //!< dequantization offset for positions
+    glm::vec3 position_scale;                           //!< dequantization scale for positions
+    float normal_encoding;                              //!< encoding of the normals (NORMAL_ENCODING_*)
 
     enum {
-        POSITION_VB,
-        NORMAL_VB,
-        COLOR_VB,
-        TEXTURE_VB,
-        WEIGHTS_VB,
+        VERTEX_VB,
         INDICES_VB,
 
         NUM_BUFFERS
     };
 
+    bool flag_loaded;                                   //!< whether the mesh resides on the GPU
+    bool flag_failed;                                   //!< whether loading the mesh from its file failed
+    size_t gpu_memory;                                  //!< bytes allocated in GPU buffers
+    size_t accounted_cpu_memory;                        //!< CPU bytes of this mesh included in total_cpu_memory
+
+    unsigned int cpu_retention;                         //!< CPU-side data kept after upload (RETAIN_* bits)
+    unsigned int mesh_type;                             //!< mesh type at the time of upload
+    unsigned int nr_vertices;                           //!< number of vertices at the time of upload
+    unsigned int nr_indices;                            //!< number of full resolution indices at the time of upload
+
+    unsigned int load_record;                           //!< record in LoadStatistics
+
+    static std::atomic<size_t> total_cpu_memory;        //!< CPU bytes held by all meshes
+    static std::atomic<size_t> total_gpu_memory;        //!< GPU bytes held by all meshes
+
     GLuint m_vertex_array_object;
     GLuint m_vertex_array_buffers[NUM_BUFFERS];
 
@@ -75,11 +219,94 @@ public:
      */
     Mesh(const std::string& filename);
 
+    /**
+     * @brief      load Mesh from file
+     *
+     *             Only touches CPU-side data and can therefore run on a
+     *             worker thread (see AssetLoader). Files that cannot be
+     *             read mark the mesh as failed instead of ending the program.
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true on success
+     */
+    bool load_mesh_from_file(const std::string& filename);
+
+    /**
+     * @brief      write the processed mesh to a binary .imesh file
+     *
+     *             The file holds the welded vertices, meshlets, levels of
+     *             detail, bounds and armature, such that loading it skips
+     *             all processing (see AssetCompiler).
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true on success
+     */
+    bool save_binary_file(const std::string& filename) const;
+
+    /**
+     * @brief      check whether a binary .imesh file has the current format
+     *
+     *             Only the header is read (see AssetCompiler::find_compiled).
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true if the file exists and matches BINARY_FILE_VERSION
+     */
+    static bool is_binary_file_current(const std::string& filename);
+
     /**
      * @brief      load the mesh on the GPU
      */
     void static_load();
 
+    /**
+     * @brief      report the upload and footprint of this mesh to another record
+     *
+     *             Used by generated meshes (e.g. Terrain) that time their own
+     *             construction.
+     *
+     * @param[in]  id    record id in LoadStatistics
+     */
+    inline void set_load_record(unsigned int id) {
+        this->load_record = id;
+    }
+
+    /**
+     * @brief      whether the mesh resides on the GPU
+     *
+     * @return     true if static_load has been called
+     */
+    inline bool is_loaded() const {
+        return this->flag_loaded;
+    }
+
+    /**
+     * @brief      whether the mesh could not be loaded from its file
+     *
+     * @return     true if load_mesh_from_file failed; such a mesh is never uploaded
+     */
+    inline bool is_failed() const {
+        return this->flag_failed;
+    }
+
+    /**
+     * @brief      get the memory occupied by the CPU-side copy of the mesh
+     *
+     * @return     size in bytes
+     */
+    size_t get_cpu_memory() const;
+
+    /**
+     * @brief      get the memory occupied by the GPU buffers of the mesh
+     *
+     * @return     size in bytes
+     */
+    inline size_t get_gpu_memory() const {
+        return this->gpu_memory;
+    }
+
     /**
      * @brief      load a default square mesh
      */
@@ -90,6 +317,84 @@ public:
      */
     void draw() const;
 
+    /**
+     * @brief      draw a level of detail of the mesh
+     *
+     *             Unlike draw(), the vertex array needs to be bound (see
+     *             bind), such that consecutive draws of the same mesh share
+     *             a single bind (see RenderQueue).
+     *
+     * @param[in]  lod   level of detail (0 is full resolution)
+     */
+    void draw(unsigned int lod) const;
+
+    /**
+     * @brief      draw several instances of a level of detail of the mesh
+     *
+     *             The vertex array needs to be bound and its per-instance
+     *             attributes set up (see InstanceBatch).
+     *
+     * @param[in]  lod           level of detail (0 is full resolution)
+     * @param[in]  nr_instances  number of instances
+     */
+    void draw_instanced(unsigned int lod, unsigned int nr_instances) const;
+
+    /**
+     * @brief      draw the meshlets that are potentially visible
+     *
+     *             Meshlets outside of the frustum or facing away from the
+     *             camera are skipped; the remaining ranges are drawn with a
+     *             single glMultiDrawElements call. The vertex array needs
+     *             to be bound (see bind).
+     *
+     * @param[in]  frustum  view frustum in model space
+     * @param[in]  camera   camera position in model space
+     * @param[in]  palette  bone matrices of the current pose (NULL if unknown)
+     *
+     * @return     number of visible meshlets
+     */
+    unsigned int draw_meshlets(const Frustum& frustum, const glm::vec3& camera, const glm::mat4* palette) const;
+
+    /**
+     * @brief      get the number of meshlets
+     *
+     * @return     number of meshlets
+     */
+    inline unsigned int get_nr_meshlets() const {
+        return this->meshlets.size();
+    }
+
+    /**
+     * @brief      select the coarsest level of detail that is visually
+     *             indistinguishable from the full resolution mesh
+     *
+     * @param[in]  pixels_per_unit  projected size of one model unit in pixels
+     * @param[in]  max_error        largest allowed error in pixels
+     *
+     * @return     level of detail
+     */
+    unsigned int select_lod(float pixels_per_unit, float max_error) const;
+
+    /**
+     * @brief      get the number of levels of detail
+     *
+     * @return     number of levels of detail
+     */
+    inline unsigned int get_nr_lods() const {
+        return this->lods.size();
+    }
+
+    /**
+     * @brief      get a level of detail
+     *
+     * @param[in]  lod   level of detail
+     *
+     * @return     element range and error of the level of detail
+     */
+    inline const MeshLod& get_lod(unsigned int lod) const {
+        return this->lods[lod];
+    }
+
     /**
      * @brief      bind the vertex attribute array
      */
@@ -106,7 +411,7 @@ public:
      * @return     number of indices
      */
     inline unsigned int get_nr_indices() const {
-        return this->indices.size();
+        return this->flag_loaded ? this->nr_indices : this->indices.size();
     }
 
     /**
@@ -115,6 +420,9 @@ public:
      * @return     number of positions
      */
     inline unsigned int get_nr_positions() const {
+        if(this->flag_loaded) {
+            return (this->mesh_type & MESH_POSITIONS) ? this->nr_vertices : 0;
+        }
         return this->positions.size();
     }
 
@@ -124,6 +432,9 @@ public:
      * @return     number of normals
      */
     inline unsigned int get_nr_normals() const {
+        if(this->flag_loaded) {
+            return (this->mesh_type & MESH_NORMALS) ? this->nr_vertices : 0;
+        }
         return this->normals.size();
     }
 
@@ -133,6 +444,9 @@ public:
      * @return     number of colors
      */
     inline unsigned int get_nr_colors() const {
+        if(this->flag_loaded) {
+            return (this->mesh_type & MESH_COLORS) ? this->nr_vertices : 0;
+        }
         return this->colors.size();
     }
 
@@ -142,6 +456,9 @@ public:
      * @return     number of texture coordinates
      */
     inline unsigned int get_nr_texture_coordinates() const {
+        if(this->flag_loaded) {
+            return (this->mesh_type & MESH_TEXTURE_COORDINATES) ? this->nr_vertices : 0;
+        }
         return this->texture_coordinates.size();
     }
 
@@ -161,6 +478,7 @@ public:
      */
     inline void set_positions(const std::vector<glm::vec3>& _positions) {
         this->positions = _positions;
+        this->compute_bounding_volumes();
     }
 
     /**
@@ -184,46 +502,46 @@ public:
     /**
      * @brief      get the start index of the indices
      *
-     * @return     pointer to indices
+     * @return     pointer to indices (NULL if released after upload)
      */
     inline const unsigned int* get_indices_start() const {
-        return &this->indices[0];
+        return this->indices.empty() ? NULL : &this->indices[0];
     }
 
     /**
      * @brief      get the start index of the positions
      *
-     * @return     pointer to positions
+     * @return     pointer to positions (NULL if released after upload)
      */
     inline const glm::vec3* get_positions_start() const {
-        return &this->positions[0];
+        return this->positions.empty() ? NULL : &this->positions[0];
     }
 
     /**
      * @brief      get the start index of the normals
      *
-     * @return     pointer to normals
+     * @return     pointer to normals (NULL if released after upload)
      */
     inline const glm::vec3* get_normals_start() const {
-        return &this->normals[0];
+        return this->normals.empty() ? NULL : &this->normals[0];
     }
 
     /**
      * @brief      get the start index of the colors
      *
-     * @return     pointer to colors
+     * @return     pointer to colors (NULL if released after upload)
      */
     inline const glm::vec4* get_colors_start() const {
-        return &this->colors[0];
+        return this->colors.empty() ? NULL : &this->colors[0];
     }
 
     /**
      * @brief      get the start index of the texture coordinates
      *
-     * @return     pointer to texture coordinates
+     * @return     pointer to texture coordinates (NULL if released after upload)
      */
     inline const glm::vec2* get_texture_coordinates_start() const {
-        return &this->texture_coordinates[0];
+        return this->texture_coordinates.empty() ? NULL : &this->texture_coordinates[0];
     }
 
     /**
@@ -239,6 +557,136 @@ public:
     static const unsigned int MESH_TEXTURE_COORDINATES = 1 << 3;    //!< has mesh texture coordinates
     static const unsigned int MESH_ARMATURE            = 1 << 4;    //!< has mesh armature
 
+    static const unsigned int COMPRESS_POSITIONS           = 1 << 0;   //!< unorm16 positions inside the bounding box
+    static const unsigned int COMPRESS_NORMALS             = 1 << 1;   //!< octahedral snorm16 normals
+    static const unsigned int COMPRESS_COLORS              = 1 << 2;   //!< unorm8 colors
+    static const unsigned int COMPRESS_TEXTURE_COORDINATES = 1 << 3;   //!< unorm16 texture coordinates
+    static const unsigned int COMPRESS_WEIGHTS             = 1 << 4;   //!< unorm8 bone weights
+
+    static const unsigned int MAX_BONE_INFLUENCES = 4;      //!< number of bones that can influence a single vertex
+    static const unsigned int COMPRESS_ALL                 = (1 << 5) - 1;
+
+    static const unsigned int RETAIN_POSITIONS           = 1 << 0;   //!< keep positions after upload
+    static const unsigned int RETAIN_NORMALS             = 1 << 1;   //!< keep normals after upload
+    static const unsigned int RETAIN_COLORS              = 1 << 2;   //!< keep colors after upload
+    static const unsigned int RETAIN_TEXTURE_COORDINATES = 1 << 3;   //!< keep texture coordinates after upload
+    static const unsigned int RETAIN_INDICES             = 1 << 4;   //!< keep indices (all levels of detail) after upload
+    static const unsigned int RETAIN_WEIGHTS             = 1 << 5;   //!< keep bone weights after upload
+    static const unsigned int RETAIN_NONE                = 0;
+    static const unsigned int RETAIN_ALL                 = (1 << 6) - 1;
+
+    static constexpr float NORMAL_ENCODING_VEC3       = 0.0f;       //!< normals are stored as vec3
+    static constexpr float NORMAL_ENCODING_OCTAHEDRAL = 1.0f;       //!< normals are octahedral encoded
+
+    /**
+     * @brief      Set the compact vertex formats used on the GPU
+     *
+     *             Needs to be called before static_load; the CPU-side data
+     *             always remains in full precision.
+     *
+     * @param[in]  flags  combination of COMPRESS_* bits
+     */
+    inline void set_vertex_compression(unsigned int flags) {
+        this->vertex_compression = flags;
+    }
+
+    /**
+     * @brief      Set which CPU-side data is kept after static_load
+     *
+     *             Counts, bounds, levels of detail and the armature are
+     *             always kept. Defaults to RETAIN_ALL.
+     *
+     * @param[in]  flags  combination of RETAIN_* bits
+     */
+    inline void set_cpu_retention(unsigned int flags) {
+        this->cpu_retention = flags;
+    }
+
+    /**
+     * @brief      Get the CPU memory held by all meshes
+     *
+     * @return     size in bytes
+     */
+    static inline size_t get_total_cpu_memory() {
+        return total_cpu_memory;
+    }
+
+    /**
+     * @brief      Get the GPU memory held by all meshes
+     *
+     * @return     size in bytes
+     */
+    static inline size_t get_total_gpu_memory() {
+        return total_gpu_memory;
+    }
+
+    /**
+     * @brief      Get the dequantization offset for the positions
+     *
+     * @return     position offset
+     */
+    inline const glm::vec3& get_position_offset() const {
+        return this->position_offset;
+    }
+
+    /**
+     * @brief      Get the dequantization scale for the positions
+     *
+     * @return     position scale
+     */
+    inline const glm::vec3& get_position_scale() const {
+        return this->position_scale;
+    }
+
+    /**
+     * @brief      Get the encoding of the normals
+     *
+     * @return     normal encoding
+     */
+    inline float get_normal_encoding() const {
+        return this->normal_encoding;
+    }
+
+    /**
+     * @brief      Get the layout of the interleaved vertex buffer
+     *
+     *             Every attribute is bound at the location given by its
+     *             type (see ShaderAttribute), as are the attributes of the
+     *             shaders of objects (see Object::load).
+     *
+     * @return     vertex layout
+     */
+    inline const std::vector<VertexAttribute>& get_vertex_layout() const {
+        return this->vertex_layout;
+    }
+
+    /**
+     * @brief      Get the size of a single vertex in the vertex buffer
+     *
+     * @return     vertex stride in bytes
+     */
+    inline unsigned int get_vertex_stride() const {
+        return this->vertex_stride;
+    }
+
+    /**
+     * @brief      Decode the vertices as the vertex shader receives them
+     *
+     *             Quantized attributes are rounded and expanded in the same
+     *             way as on the GPU, such that CPU-side skinning (see
+     *             Skinning) reproduces the shader. Requires the positions,
+     *             normals and bone weights on the CPU (see RETAIN_*).
+     *
+     * @param[out] _positions     dequantized positions
+     * @param[out] _normals       decoded normals
+     * @param[out] _bone_indices  bones influencing every vertex
+     * @param[out] _bone_weights  weights of these bones
+     *
+     * @return     false if the required CPU-side data is not available
+     */
+    bool decode_vertices(std::vector<glm::vec3>* _positions, std::vector<glm::vec3>* _normals,
+                         std::vector<glm::uvec4>* _bone_indices, std::vector<glm::vec4>* _bone_weights);
+
     /**
      * @brief      Get the bone size.
      *
@@ -256,51 +704,196 @@ public:
     }
 
     /**
-     * @brief      center the vertex coordinates around the origin in model space
+     * @brief      Get the number of animation clips.
+     *
+     * @return     number of animation clips
+     */
+    inline unsigned int get_nr_animation_clips() const {
+        return this->animation_clips.size();
+    }
+
+    /**
+     * @brief      Get an animation clip.
+     *
+     * @param[in]  idx   index of the clip
+     *
+     * @return     pointer to the clip
      */
-    void center();
+    inline const AnimationClip* get_animation_clip(unsigned int idx) const {
+        return this->animation_clips[idx];
+    }
+
+    /**
+     * @brief      Find an animation clip by its name.
+     *
+     * @param[in]  name  name of the clip
+     *
+     * @return     pointer to the clip (NULL if the mesh has no such clip)
+     */
+    const AnimationClip* find_animation_clip(const std::string& name) const;
+
+    /**
+     * @brief      Get the axis-aligned bounding box of the rest pose
+     *
+     * @return     bounding box in model space
+     */
+    inline const BoundingBox& get_bounding_box() const {
+        return this->bounding_box;
+    }
+
+    /**
+     * @brief      Get the smallest sphere enclosing the rest pose
+     *
+     * @return     bounding sphere in model space
+     */
+    inline const BoundingSphere& get_bounding_sphere() const {
+        return this->bounding_sphere;
+    }
+
+    /**
+     * @brief      Get a sphere that encloses the mesh in every pose
+     *
+     *             Covers the rotations about the joints as well as the
+     *             translations and scales that the animation clips apply
+     *             to the bones; equals the bounding sphere for meshes
+     *             without an armature.
+     *
+     * @return     bounding sphere in model space
+     */
+    inline const BoundingSphere& get_pose_bounding_sphere() const {
+        return this->pose_bounding_sphere;
+    }
+
+    /**
+     * @brief      Get an axis-aligned box that encloses the mesh in every pose
+     *
+     * @return     bounding box in model space
+     */
+    BoundingBox get_pose_bounding_box() const;
+
+    /**
+     * @brief      build the chain of simplified levels of detail
+     *
+     *             Every level roughly halves the number of triangles of the
+     *             previous one; the chain stops when the simplifier can no
+     *             longer make meaningful progress (e.g. due to seams).
+     */
+    void build_lod_chain();
+
+    static const unsigned int MAX_LODS = 5;                     //!< maximum number of levels of detail
+
+    /**
+     * @brief      split the full resolution indices into meshlets
+     *
+     *             Triangles are grouped by growing clusters over shared
+     *             vertices; the indices are reordered such that every
+     *             meshlet is a contiguous range. Skinned triangles are only
+     *             grouped with triangles that follow the same bone.
+     */
+    void build_meshlets();
+
+    static const unsigned int MESHLET_MAX_VERTICES = 64;       //!< maximum number of vertices per meshlet
+    static const unsigned int MESHLET_MAX_TRIANGLES = 124;     //!< maximum number of triangles per meshlet
+    static const int MESHLET_STATIC = -1;                       //!< meshlet does not move
+    static const int MESHLET_DEFORMING = -2;                    //!< meshlet deforms and is never culled
+
+    static const uint32_t BINARY_FILE_VERSION = 5;              //!< version of the .imesh format
 
     ~Mesh();
 
 private:
     /**
-     * @brief      load Mesh from file
+     * @brief      get the bone that moves a triangle rigidly
      *
-     * @param[in]  filename  The filename
+     * @param[in]  t     index of the triangle
+     *
+     * @return     bone index, MESHLET_STATIC or MESHLET_DEFORMING
+     */
+    int get_triangle_bone(unsigned int t) const;
+
+    /**
+     * @brief      free the CPU-side data that is not retained
+     */
+    void release_cpu_data();
+
+    /**
+     * @brief      update the process-wide CPU memory counter for this mesh
+     */
+    void update_memory_accounting();
+
+    /**
+     * @brief      compute the bounding box and bounding spheres
+     */
+    void compute_bounding_volumes();
+
+    /**
+     * @brief      merge vertices that have identical attributes
+     *
+     *             The file loaders emit a vertex per triangle corner; the
+     *             simplifier requires shared vertices to find neighbours.
+     */
+    void weld_vertices();
+
+    /**
+     * @brief      build the interleaved vertex layout from the mesh type
+     */
+    void build_vertex_layout();
+
+    /**
+     * @brief      pack all vertex attributes into a single interleaved buffer
+     *
+     * @return     interleaved vertex data
      */
-    void load_mesh_from_file(const std::string& filename);
+    std::vector<uint8_t> build_vertex_buffer() const;
 
     /**
      * @brief      load Mesh from an .obj file
      *
      * @param[in]  filename  The filename
+     * @param      f         contents of the file
+     *
+     * @return     true on success
      */
-    void load_mesh_from_obj_file(const std::string& filename);
+    bool load_mesh_from_obj_file(const std::string& filename, std::istream* f);
 
     /**
      * @brief      load Mesh from an .x file
      *
      * @param[in]  filename  The filename
+     * @param      f         contents of the file
+     *
+     * @return     true on success
+     */
+    bool load_mesh_from_x_file(const std::string& filename, std::istream* f);
+
+    /**
+     * @brief      load Mesh from a binary .imesh file
+     *
+     *             The file is memory-mapped and copied into place.
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true on success
      */
-    void load_mesh_from_x_file(const std::string& filename);
+    bool load_mesh_from_binary_file(const std::string& filename);
 
     /**
-     * @brief      read frame transform matrix from ifstream
+     * @brief      read frame transform matrix from a stream
      *
-     * @param      f     ifstream pointer
+     * @param      f     stream pointer
      *
      * @return     matrix
      */
-    glm::mat4 read_frame_transform_matrix(std::ifstream* f);
+    glm::mat4 read_frame_transform_matrix(std::istream* f);
 
     /**
-     * @brief      read matrix from ifstream
+     * @brief      read matrix from a stream
      *
-     * @param      f     ifstream pointer
+     * @param      f     stream pointer
      *
      * @return     matrix
      */
-    glm::mat4 read_matrix(std::ifstream* f);
+    glm::mat4 read_matrix(std::istream* f);
 };
 
 
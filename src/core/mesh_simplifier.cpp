@@ -0,0 +1,404 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "mesh_simplifier.h"
+
+#include <map>
+
+/**
+ * @brief      strict weak ordering of positions, used to find coincident vertices
+ */
+struct PositionCompare {
+    bool operator()(const glm::vec3& a, const glm::vec3& b) const {
+        if(a.x != b.x) {
+            return a.x < b.x;
+        }
+        if(a.y != b.y) {
+            return a.y < b.y;
+        }
+        return a.z < b.z;
+    }
+};
+
+/**
+ * @brief      construct the quadric of a single plane
+ *
+ * @param[in]  n     unit normal of the plane
+ * @param[in]  d     distance of the plane to the origin
+ * @param[in]  area  weight of the plane
+ */
+MeshSimplifier::Quadric::Quadric(const glm::vec3& n, double d, double area) {
+    this->a2 = area * n.x * n.x;
+    this->ab = area * n.x * n.y;
+    this->ac = area * n.x * n.z;
+    this->ad = area * n.x * d;
+    this->b2 = area * n.y * n.y;
+    this->bc = area * n.y * n.z;
+    this->bd = area * n.y * d;
+    this->c2 = area * n.z * n.z;
+    this->cd = area * n.z * d;
+    this->d2 = area * d * d;
+    this->w = area;
+}
+
+/**
+ * @brief      accumulate another quadric
+ *
+ * @param[in]  o     quadric to add
+ *
+ * @return     reference to this quadric
+ */
+MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& o) {
+    this->a2 += o.a2;
+    this->ab += o.ab;
+    this->ac += o.ac;
+    this->ad += o.ad;
+    this->b2 += o.b2;
+    this->bc += o.bc;
+    this->bd += o.bd;
+    this->c2 += o.c2;
+    this->cd += o.cd;
+    this->d2 += o.d2;
+    this->w += o.w;
+
+    return *this;
+}
+
+/**
+ * @brief      area weighted mean squared distance of a point to the planes
+ *
+ * @param[in]  p     point
+ *
+ * @return     mean squared distance
+ */
+double MeshSimplifier::Quadric::evaluate(const glm::vec3& p) const {
+    const double x = p.x;
+    const double y = p.y;
+    const double z = p.z;
+
+    const double r = this->a2 * x * x + 2.0 * this->ab * x * y + 2.0 * this->ac * x * z + 2.0 * this->ad * x
+                   + this->b2 * y * y + 2.0 * this->bc * y * z + 2.0 * this->bd * y
+                   + this->c2 * z * z + 2.0 * this->cd * z
+                   + this->d2;
+
+    return std::fabs(r) / std::max(this->w, 1e-12);
+}
+
+/**
+ * @brief      MeshSimplifier constructor
+ *
+ * @param[in]  _positions  vertex positions
+ * @param[in]  indices     triangle indices of the full resolution mesh
+ */
+MeshSimplifier::MeshSimplifier(const std::vector<glm::vec3>& _positions, const std::vector<unsigned int>& indices) {
+    this->positions = _positions;
+    this->attribute_stride = 0;
+
+    const unsigned int nr_vertices = this->positions.size();
+
+    // vertices sharing a single position (seams) map onto the same canonical vertex
+    std::map<glm::vec3, unsigned int, PositionCompare> unique_positions;
+    std::vector<unsigned int> group_size(nr_vertices, 0);
+    this->position_ids.resize(nr_vertices);
+    for(unsigned int i=0; i<nr_vertices; i++) {
+        std::map<glm::vec3, unsigned int, PositionCompare>::const_iterator it = unique_positions.find(this->positions[i]);
+        if(it == unique_positions.end()) {
+            unique_positions[this->positions[i]] = i;
+            this->position_ids[i] = i;
+        } else {
+            this->position_ids[i] = it->second;
+        }
+        group_size[this->position_ids[i]]++;
+    }
+
+    // count the number of triangles sharing every (position) edge
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> edges;
+    for(unsigned int i=0; i<indices.size(); i+=3) {
+        for(unsigned int k=0; k<3; k++) {
+            const unsigned int a = this->position_ids[indices[i+k]];
+            const unsigned int b = this->position_ids[indices[i+(k+1)%3]];
+            edges[std::make_pair(std::min(a,b), std::max(a,b))]++;
+        }
+    }
+
+    // lock seams, borders and non-manifold edges
+    std::vector<bool> locked_positions(nr_vertices, false);
+    for(std::map<std::pair<unsigned int, unsigned int>, unsigned int>::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+        if(it->second != 2) {
+            locked_positions[it->first.first] = true;
+            locked_positions[it->first.second] = true;
+        }
+    }
+
+    this->locked.resize(nr_vertices);
+    for(unsigned int i=0; i<nr_vertices; i++) {
+        const unsigned int p = this->position_ids[i];
+        this->locked[i] = group_size[p] > 1 || locked_positions[p];
+    }
+
+    // accumulate the planes of all triangles onto their corners
+    this->quadrics.resize(nr_vertices);
+    this->position_planes.resize(nr_vertices);
+    for(unsigned int i=0; i<indices.size(); i+=3) {
+        const glm::vec3& p0 = this->positions[indices[i]];
+        const glm::vec3& p1 = this->positions[indices[i+1]];
+        const glm::vec3& p2 = this->positions[indices[i+2]];
+
+        const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        const float l = glm::length(n);
+        if(l <= 0.0f) {
+            continue;
+        }
+
+        const glm::vec3 nn = n / l;
+        const Quadric q(nn, -glm::dot(nn, p0), 0.5 * l);
+        for(unsigned int k=0; k<3; k++) {
+            this->quadrics[this->position_ids[indices[i+k]]] += q;
+            this->position_planes[this->position_ids[indices[i+k]]].push_back(this->planes.size());
+        }
+        this->planes.push_back(glm::vec4(nn, -glm::dot(nn, p0)));
+    }
+}
+
+/**
+ * @brief      only allow collapses between vertices with equal attributes
+ *
+ * @param[in]  _attributes  per vertex attributes (e.g. bone weights)
+ * @param[in]  stride       number of attributes per vertex
+ */
+void MeshSimplifier::set_vertex_attributes(const std::vector<float>& _attributes, unsigned int stride) {
+    this->attributes = _attributes;
+    this->attribute_stride = stride;
+}
+
+/**
+ * @brief      simplify a set of triangles
+ *
+ * @param[in]  indices       triangle indices to simplify
+ * @param[in]  target_count  desired number of indices
+ * @param[out] error         geometric error of the result (in model units)
+ *
+ * @return     indices of the simplified mesh
+ */
+std::vector<unsigned int> MeshSimplifier::simplify(const std::vector<unsigned int>& indices, unsigned int target_count, float* error) const {
+    struct Collapse {
+        unsigned int u;
+        unsigned int v;
+        double cost;
+
+        bool operator<(const Collapse& o) const {
+            return this->cost < o.cost;
+        }
+    };
+
+    const unsigned int nr_vertices = this->positions.size();
+    std::vector<unsigned int> result = indices;
+    std::vector<Quadric> q = this->quadrics;
+    std::vector<std::vector<unsigned int> > around = this->position_planes;
+    float max_error = 0.0f;
+
+    // perform passes of independent (non-overlapping) collapses in order of increasing cost
+    while(result.size() > target_count) {
+        std::vector<std::vector<unsigned int> > adjacency(nr_vertices);
+        for(unsigned int i=0; i<result.size(); i+=3) {
+            for(unsigned int k=0; k<3; k++) {
+                adjacency[result[i+k]].push_back(i);
+            }
+        }
+
+        std::vector<Collapse> collapses;
+        for(unsigned int i=0; i<result.size(); i+=3) {
+            for(unsigned int k=0; k<6; k++) {
+                const unsigned int u = result[i + k % 3];
+                const unsigned int v = result[i + (k < 3 ? (k + 1) % 3 : (k + 2) % 3)];
+
+                if(this->locked[u] || this->position_ids[u] == this->position_ids[v]) {
+                    continue;
+                }
+
+                Quadric qc = q[this->position_ids[u]];
+                qc += q[this->position_ids[v]];
+
+                Collapse c;
+                c.u = u;
+                c.v = v;
+                c.cost = qc.evaluate(this->positions[v]);
+                collapses.push_back(c);
+            }
+        }
+        std::sort(collapses.begin(), collapses.end());
+
+        std::vector<unsigned int> remap(nr_vertices);
+        for(unsigned int i=0; i<nr_vertices; i++) {
+            remap[i] = i;
+        }
+
+        std::vector<bool> touched(nr_vertices, false);
+        unsigned int removed = 0;
+        unsigned int nr_collapses = 0;
+
+        for(unsigned int i=0; i<collapses.size(); i++) {
+            if(result.size() - removed * 3 <= target_count) {
+                break;
+            }
+
+            const unsigned int u = collapses[i].u;
+            const unsigned int v = collapses[i].v;
+            const unsigned int pu = this->position_ids[u];
+            const unsigned int pv = this->position_ids[v];
+
+            if(touched[pu] || touched[pv]) {
+                continue;
+            }
+
+            if(!this->attributes_match(u, v) || this->collapse_flips(result, adjacency[u], u, v)) {
+                continue;
+            }
+
+            remap[u] = v;
+            q[pv] += q[pu];
+
+            // the quadric cost only ranks collapses; the error is the worst distance of the
+            // surviving vertex to the original surface that both vertices stood for
+            around[pv].insert(around[pv].end(), around[pu].begin(), around[pu].end());
+            std::sort(around[pv].begin(), around[pv].end());
+            around[pv].erase(std::unique(around[pv].begin(), around[pv].end()), around[pv].end());
+            for(unsigned int j=0; j<around[pv].size(); j++) {
+                const glm::vec4& plane = this->planes[around[pv][j]];
+                max_error = std::max(max_error, std::fabs(glm::dot(glm::vec3(plane), this->positions[v]) + plane.w));
+            }
+
+            // the neighbourhood of u changes; postpone collapses there to the next pass
+            for(unsigned int j=0; j<adjacency[u].size(); j++) {
+                const unsigned int t = adjacency[u][j];
+                bool shares_edge = false;
+                for(unsigned int k=0; k<3; k++) {
+                    const unsigned int p = this->position_ids[result[t+k]];
+                    touched[p] = true;
+                    shares_edge |= (p == pv);
+                }
+                removed += shares_edge ? 1 : 0;
+            }
+
+            nr_collapses++;
+        }
+
+        if(nr_collapses == 0) {
+            break;
+        }
+
+        // rebuild the triangle list and drop all degenerate triangles
+        std::vector<unsigned int> next;
+        next.reserve(result.size());
+        for(unsigned int i=0; i<result.size(); i+=3) {
+            const unsigned int a = remap[result[i]];
+            const unsigned int b = remap[result[i+1]];
+            const unsigned int c = remap[result[i+2]];
+
+            const unsigned int pa = this->position_ids[a];
+            const unsigned int pb = this->position_ids[b];
+            const unsigned int pc = this->position_ids[c];
+
+            if(pa == pb || pb == pc || pa == pc) {
+                continue;
+            }
+
+            next.push_back(a);
+            next.push_back(b);
+            next.push_back(c);
+        }
+        result.swap(next);
+    }
+
+    if(error) {
+        *error = max_error;
+    }
+
+    return result;
+}
+
+/**
+ * @brief      check whether two vertices carry the same attributes
+ *
+ * @param[in]  u     first vertex
+ * @param[in]  v     second vertex
+ *
+ * @return     true if the attributes match
+ */
+bool MeshSimplifier::attributes_match(unsigned int u, unsigned int v) const {
+    for(unsigned int k=0; k<this->attribute_stride; k++) {
+        if(std::fabs(this->attributes[u * this->attribute_stride + k] - this->attributes[v * this->attribute_stride + k]) > 1e-3f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief      check whether moving vertex u onto v flips any triangle
+ *
+ * @param[in]  indices    current triangle indices
+ * @param[in]  triangles  triangles adjacent to u
+ * @param[in]  u          vertex to remove
+ * @param[in]  v          vertex to collapse onto
+ *
+ * @return     true if a triangle flips or degenerates
+ */
+bool MeshSimplifier::collapse_flips(const std::vector<unsigned int>& indices, const std::vector<unsigned int>& triangles,
+                                    unsigned int u, unsigned int v) const {
+    const unsigned int pv = this->position_ids[v];
+
+    for(unsigned int i=0; i<triangles.size(); i++) {
+        const unsigned int t = triangles[i];
+
+        glm::vec3 p[3];
+        glm::vec3 pn[3];
+        bool removed = false;
+        for(unsigned int k=0; k<3; k++) {
+            const unsigned int idx = indices[t+k];
+            removed |= (this->position_ids[idx] == pv);
+            p[k] = this->positions[idx];
+            pn[k] = (idx == u) ? this->positions[v] : p[k];
+        }
+
+        // triangles sharing the collapsed edge disappear
+        if(removed) {
+            continue;
+        }
+
+        const glm::vec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+        const glm::vec3 n1 = glm::cross(pn[1] - pn[0], pn[2] - pn[0]);
+
+        const float l0 = glm::length(n0);
+        const float l1 = glm::length(n1);
+
+        if(l1 <= 1e-12f) {
+            return true;
+        }
+
+        if(l0 > 0.0f && glm::dot(n0, n1) < 0.25f * l0 * l1) {
+            return true;
+        }
+    }
+
+    return false;
+}
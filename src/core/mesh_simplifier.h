@@ -0,0 +1,128 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _MESH_SIMPLIFIER_H
+#define _MESH_SIMPLIFIER_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+/**
+ * @brief      reduces the number of triangles of an indexed mesh using
+ *             quadric error metrics
+ *
+ *             Vertices are only moved onto one of their neighbours (half edge
+ *             collapse), such that all levels of detail share the original
+ *             vertex buffer and only differ in their index buffer. Vertices
+ *             on UV or skin-weight seams (several vertices at a single
+ *             position) and on open borders are never collapsed.
+ */
+class MeshSimplifier {
+private:
+    /**
+     * @brief      symmetric 4x4 matrix measuring the squared distance to a
+     *             set of planes
+     */
+    struct Quadric {
+        double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+        double w;   //!< accumulated area of the planes
+
+        Quadric() : a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0), w(0) {}
+
+        Quadric(const glm::vec3& n, double d, double area);
+
+        Quadric& operator+=(const Quadric& o);
+
+        double evaluate(const glm::vec3& p) const;
+    };
+
+    std::vector<glm::vec3> positions;           //!< vertex positions
+    std::vector<unsigned int> position_ids;     //!< canonical vertex for every position
+    std::vector<bool> locked;                   //!< whether a vertex may be collapsed
+
+    std::vector<float> attributes;              //!< attributes that need to match for a collapse
+    unsigned int attribute_stride;              //!< number of attributes per vertex
+
+    std::vector<Quadric> quadrics;              //!< quadric per canonical vertex
+
+    std::vector<glm::vec4> planes;                              //!< plane (unit normal, distance) of every input triangle
+    std::vector<std::vector<unsigned int> > position_planes;    //!< planes around every canonical vertex
+
+public:
+    /**
+     * @brief      MeshSimplifier constructor
+     *
+     * @param[in]  _positions  vertex positions
+     * @param[in]  indices     triangle indices of the full resolution mesh
+     */
+    MeshSimplifier(const std::vector<glm::vec3>& _positions, const std::vector<unsigned int>& indices);
+
+    /**
+     * @brief      only allow collapses between vertices with equal attributes
+     *
+     * @param[in]  _attributes  per vertex attributes (e.g. bone weights)
+     * @param[in]  stride       number of attributes per vertex
+     */
+    void set_vertex_attributes(const std::vector<float>& _attributes, unsigned int stride);
+
+    /**
+     * @brief      simplify a set of triangles
+     *
+     * @param[in]  indices       triangle indices to simplify
+     * @param[in]  target_count  desired number of indices
+     * @param[out] error         geometric error of the result (in model units): the
+     *                           largest distance of a vertex that took over a collapsed
+     *                           vertex to any of the original planes around both
+     *
+     * @return     indices of the simplified mesh
+     */
+    std::vector<unsigned int> simplify(const std::vector<unsigned int>& indices, unsigned int target_count, float* error) const;
+
+private:
+    /**
+     * @brief      check whether two vertices carry the same attributes
+     *
+     * @param[in]  u     first vertex
+     * @param[in]  v     second vertex
+     *
+     * @return     true if the attributes match
+     */
+    bool attributes_match(unsigned int u, unsigned int v) const;
+
+    /**
+     * @brief      check whether moving vertex u onto v flips any triangle
+     *
+     * @param[in]  indices    current triangle indices
+     * @param[in]  triangles  triangles adjacent to u
+     * @param[in]  u          vertex to remove
+     * @param[in]  v          vertex to collapse onto
+     *
+     * @return     true if a triangle flips or degenerates
+     */
+    bool collapse_flips(const std::vector<unsigned int>& indices, const std::vector<unsigned int>& triangles,
+                        unsigned int u, unsigned int v) const;
+};
+
+#endif //_MESH_SIMPLIFIER_H
@@ -19,65 +19,8 @@
 #**************************************************************************/
 
 #include "object.h"
-
-/**
- * @brief      ObjectProperty constructor
- *
- * @param[in]  _name  The name
- * @param[in]  _type  The type
- * @param[in]  _size  The size
- */
-ObjectProperty::ObjectProperty(const std::string& _name, unsigned int _type, unsigned int _size) {
-    this->name = _name;
-
-    switch(_type) {
-        case ShaderUniform::MAT4:
-            this->base_size = 16;
-            break;
-        case ShaderUniform::VEC4:
-            this->base_size = 4;
-            break;
-        case ShaderUniform::VEC3:
-            this->base_size = 3;
-            break;
-        case ShaderUniform::VEC2:
-            this->base_size = 2;
-            break;
-        case ShaderUniform::TEXTURE:
-            this->base_size = 1;
-            break;
-        case  ShaderUniform::UINT:
-            this->base_size = 1;
-            break;
-        case  ShaderUniform::FLOAT:
-            this->base_size = 1;
-            break;
-        case  ShaderUniform::FRAME_MATRIX:
-            this->base_size = 16;
-            break;
-        case  ShaderUniform::OFFSET_MATRIX:
-            this->base_size = 16;
-            break;
-        default:
-            this->base_size = 1;
-        break;
-    }
-
-    this->val.resize(_size * base_size, 0.0f);
-    this->size = _size;
-    this->type = _type;
-}
-
-/**
- * @brief      Set the value of the ObjectProperty
- *
- * @param[in]  val   value to set
- */
-void ObjectProperty::set_value(const float* _val) {
-    for(unsigned int i=0; i<this->size * this->base_size; i++) {
-        this->val[i] = _val[i];
-    }
-}
+#include "core/render_queue.h"
+#include "core/frame_constants.h"
 
 /**
  * @brief      Object constructor
@@ -92,26 +35,11 @@ Object::Object(Shader* _shader, const Mesh* _mesh) {
     this->mesh = _mesh;
     this->scale = glm::mat4(1.0f);
     this->position = glm::vec3(0.0f);
-    this->angle = 0.0;
-    this->rig_idx = 0;
-
-    this->add_property("model", ShaderUniform::MAT4, 1);
-    this->add_property("view", ShaderUniform::MAT4, 1);
-    this->add_property("mvp", ShaderUniform::MAT4, 1);
-    this->add_property("ambient_light", ShaderUniform::VEC4, 1);
-
-    if(this->mesh->get_type() & Mesh::MESH_TEXTURE_COORDINATES) {
-        this->add_property("tex", ShaderUniform::TEXTURE, 1);
-    }
-
-    if(this->mesh->get_type() & Mesh::MESH_ARMATURE) {
-        this->is_rigged = true;
-        this->rig_idx = this->add_property("armature", ShaderUniform::MAT4, this->mesh->get_armature()->get_nr_bones());
-        this->mesh->get_armature()->set_bone_transformation(2, glm::rotate(glm::mat4(1.0), (float)M_PI / 2.0f, glm::vec3(0,0,1)));
-        this->mesh->get_armature()->set_bone_transformation(1, glm::rotate(glm::mat4(1.0), float(rand() * M_PI), glm::vec3(0,0,1)));
-        this->mesh->get_armature()->build_frame_matrices();
-        this->mesh->get_armature()->build_glsl_matrices();
-    }
+    this->pose = NULL;
+    this->animation_lag = 0.0f;
+    this->animation_lod = ANIMATION_NONE;
+    this->flag_loaded = false;
+    this->model_uniform = -1;
 
     this->texture_id = -1;
 }
@@ -130,94 +58,195 @@ Object::Object(Shader* _shader, const Mesh* _mesh, int _texture_id) {
     this->mesh = _mesh;
     this->scale = glm::mat4(1.0f);
     this->position = glm::vec3(0.0f);
-    this->angle = 0.0;
-    this->rig_idx = 0;
+    this->pose = NULL;
+    this->animation_lag = 0.0f;
+    this->animation_lod = ANIMATION_NONE;
+    this->flag_loaded = false;
+    this->model_uniform = -1;
 
-    this->add_property("model", ShaderUniform::MAT4, 1);
-    this->add_property("view", ShaderUniform::MAT4, 1);
-    this->add_property("mvp", ShaderUniform::MAT4, 1);
-    this->add_property("ambient_light", ShaderUniform::VEC4, 1);
+    this->texture_id = _texture_id;
+}
 
-    if(this->mesh->get_type() & Mesh::MESH_TEXTURE_COORDINATES) {
-        this->add_property("tex", ShaderUniform::TEXTURE, 1);
-    }
+/**
+ * @brief      queue the object to be drawn on its own
+ */
+void Object::submit() {
+    const unsigned int lod = this->select_lod(FrameConstants::get().get_projection());
+    const float depth = glm::length(this->position - FrameConstants::get().get_camera_position());
 
-    if(this->mesh->get_type() & Mesh::MESH_ARMATURE) {
-        this->is_rigged = true;
-        this->rig_idx = this->add_property("armature", ShaderUniform::MAT4, this->mesh->get_armature()->get_nr_bones());
-        this->mesh->get_armature()->set_bone_transformation(2, glm::rotate(glm::mat4(1.0), (float)M_PI / 2.0f, glm::vec3(0,0,1)));
-        this->mesh->get_armature()->set_bone_transformation(1, glm::rotate(glm::mat4(1.0), float(rand() * M_PI), glm::vec3(0,0,1)));
-        this->mesh->get_armature()->build_frame_matrices();
-        this->mesh->get_armature()->build_glsl_matrices();
-    }
+    RenderQueue::get().submit(this, lod, RenderQueue::PASS_OPAQUE, depth);
+}
 
-    this->texture_id = _texture_id;
+/**
+ * @brief      draw a level of detail of the object
+ *
+ * @param[in]  lod   level of detail
+ */
+void Object::draw(unsigned int lod) {
+    const glm::mat4 model = this->get_model_matrix();
+
+    this->set_properties(model);
+
+    if(lod == 0 && this->mesh->get_nr_meshlets() > 0) {
+        // cull clusters against the frustum and camera in model space
+        const glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(FrameConstants::get().get_camera_position(), 1.0f));
+        this->mesh->draw_meshlets(Frustum(FrameConstants::get().get_view_projection() * model), camera, this->get_palette());
+    } else {
+        this->mesh->draw(lod);
+    }
 }
 
 /**
- * @brief      draw the object
+ * @brief      set the uniforms from the values of this object
+ *
+ * @param[in]  model  model matrix
  */
-void Object::draw() {
-    if(this->texture_id > -1) {
-        TextureManager::get().bind_texture(this->texture_id);
+void Object::set_properties(const glm::mat4& model) {
+    if(this->model_uniform >= 0) {
+        this->shader->store_uniform(&this->uniforms[0], this->model_uniform, glm::value_ptr(model));
     }
 
-    glm::mat4 view = Camera::get().get_view();
-    glm::mat4 projection = Camera::get().get_projection();
-    glm::mat4 model = glm::translate(glm::mat4(1.0f), this->position) * this->rotation * this->scale;
-    glm::mat4 mvp = projection * view * model;
-    glm::vec4 sky_color = Sky::get().get_sky_color();
+    this->shader->set_uniforms(&this->uniforms[0]);
+}
 
-    this->properties[0].set_value(glm::value_ptr(model));
-    this->properties[1].set_value(glm::value_ptr(view));
-    this->properties[2].set_value(glm::value_ptr(mvp));
-    this->properties[3].set_value(glm::value_ptr(sky_color));
+/**
+ * @brief      whether the object lies (partially) inside a view frustum
+ *
+ * @param[in]  view_projection  view-projection matrix
+ *
+ * @return     true if the sphere enclosing every pose intersects the frustum
+ */
+bool Object::is_visible(const glm::mat4& view_projection) const {
+    const BoundingSphere& sphere = this->mesh->get_pose_bounding_sphere();
+    return Frustum(view_projection * this->get_model_matrix()).intersects_sphere(sphere.center, sphere.radius);
+}
 
-    this->mesh->bind();
+/**
+ * @brief      select the level of detail from the projected size of the object
+ *
+ * @param[in]  projection  projection matrix
+ *
+ * @return     level of detail
+ */
+unsigned int Object::select_lod(const glm::mat4& projection) const {
+    return this->mesh->select_lod(this->get_pixels_per_unit(projection), LOD_MAX_PIXEL_ERROR);
+}
 
-    this->shader->link_shader();
-    for(unsigned int i=0; i<this->properties.size(); i++) {
-        this->shader->set_uniform(i, this->properties[i].get_value());
-    }
+/**
+ * @brief      get the size of a model unit on the screen
+ *
+ * @param[in]  projection  projection matrix
+ *
+ * @return     pixels per model unit at the distance of the object
+ */
+float Object::get_pixels_per_unit(const glm::mat4& projection) const {
+    const float distance = std::max(glm::length(FrameConstants::get().get_camera_position() - this->position), 0.1f);
 
-    this->mesh->draw();
+    // largest scaling factor of the model matrix
+    const float scaling = std::max(glm::length(glm::vec3(this->scale[0])),
+                          std::max(glm::length(glm::vec3(this->scale[1])),
+                                   glm::length(glm::vec3(this->scale[2]))));
 
-    this->mesh->unbind();
+    return scaling * projection[1][1] * 0.5f * (float)Screen::get().get_height() / distance;
 }
 
 /**
- * @brief      load the object into memory
+ * @brief      select the time between two samples of the pose
+ *
+ * @return     interval in seconds; 0 to sample in every update and
+ *             negative if the object is not visible
  */
-void Object::load() {
-    // load uniforms
-    for(unsigned int i=0; i<this->properties.size(); i++) {
-        this->shader->add_uniform(this->properties[i].get_type(), this->properties[i].get_name(), this->properties[i].get_size());
-    }
+float Object::select_animation_interval() const {
+    // updates run before the frame is drawn, so this uses the camera of the last frame
+    const glm::mat4& projection = FrameConstants::get().get_projection();
+    const BoundingSphere& sphere = this->mesh->get_pose_bounding_sphere();
 
-    // load attributes (depend on mesh)
-    unsigned int mesh_type = this->mesh->get_type();
-    if(mesh_type & Mesh::MESH_POSITIONS) {
-        this->shader->add_attribute(ShaderAttribute::POSITION, "position");
+    if(!this->is_visible(FrameConstants::get().get_view_projection())) {
+        return -1.0f;
     }
-    if(mesh_type & Mesh::MESH_NORMALS) {
-        this->shader->add_attribute(ShaderAttribute::NORMAL, "normal");
-    }
-    if(mesh_type & Mesh::MESH_COLORS) {
-        this->shader->add_attribute(ShaderAttribute::COLOR, "color");
-    }
-    if(mesh_type & Mesh::MESH_TEXTURE_COORDINATES) {
-        this->shader->add_attribute(ShaderAttribute::TEXTURE_COORDINATE, "texture_coordinate");
+
+    const float pixels = 2.0f * sphere.radius * this->get_pixels_per_unit(projection);
+    if(pixels >= ANIMATION_FULL_RATE_PIXELS) {
+        return 0.0f;
     }
-    if(mesh_type & Mesh::MESH_ARMATURE) {
-        this->shader->add_attribute(ShaderAttribute::WEIGHT, "weights");
+
+    // halve the rate every time the projected size halves
+    const float interval = ANIMATION_MIN_INTERVAL * ANIMATION_FULL_RATE_PIXELS / std::max(pixels, 1.0f);
+    return (interval < ANIMATION_MAX_INTERVAL) ? interval : ANIMATION_MAX_INTERVAL;
+}
+
+/**
+ * @brief      whether all assets of the object have been loaded
+ *
+ * @return     true if load can be called
+ */
+bool Object::assets_ready() const {
+    if(!this->mesh->is_loaded()) {
+        return false;
     }
 
+    return this->texture_id < 0 || TextureManager::get().is_loaded(this->texture_id);
+}
+
+/**
+ * @brief      load the object into memory
+ */
+void Object::load() {
+    // the values below depend on the contents of the mesh, which need
+    // not be available when the object is constructed (see AssetLoader)
+    const bool rigged = this->mesh->get_type() & Mesh::MESH_ARMATURE;
+
+    // shaders are shared and objects load in any order, so the first object registers
+    // the same uniforms and attributes whatever its mesh; unused ones are ignored by GL
     if(!this->shader->is_loaded()) {
+        this->shader->add_uniform(ShaderUniform::MAT4, "model", 1);
+
+        // dequantization parameters of the compact vertex formats
+        this->shader->add_uniform(ShaderUniform::VEC3, "position_offset", 1);
+        this->shader->add_uniform(ShaderUniform::VEC3, "position_scale", 1);
+        this->shader->add_uniform(ShaderUniform::FLOAT, "normal_encoding", 1);
+
+        this->shader->add_uniform(ShaderUniform::TEXTURE, "tex", 1);
+        this->shader->add_uniform(ShaderUniform::INT, "palettes", 1);
+
+        // every attribute is bound at the location given by its type (see Mesh::static_load)
+        static const char* attribute_names[ShaderAttribute::NUM_ATTR_TYPES] = {
+            "position", "normal", "color", "texture_coordinate", "weights", "bone_ids",
+            "instance_palette_offset", "instance_model"
+        };
+        for(unsigned int i=0; i<ShaderAttribute::NUM_ATTR_TYPES; i++) {
+            this->shader->add_attribute(i, attribute_names[i]);
+        }
+
         // corresponding mesh needs to be bound when vertex array gets loaded
         this->mesh->bind();
         this->shader->bind_uniforms_and_attributes();
         this->mesh->unbind();
     }
+
+    // all values live in a single array, laid out once per shader
+    this->uniforms.assign(this->shader->get_nr_uniform_floats(), 0.0f);
+    this->model_uniform = this->shader->get_uniform_id("model");
+
+    this->set_uniform_value("position_offset", glm::value_ptr(this->mesh->get_position_offset()));
+    this->set_uniform_value("position_scale", glm::value_ptr(this->mesh->get_position_scale()));
+    const float normal_encoding = this->mesh->get_normal_encoding();
+    this->set_uniform_value("normal_encoding", &normal_encoding);
+
+    if(rigged) {
+        this->is_rigged = true;
+        const float palette_unit = (float)PaletteBuffer::TEXTURE_UNIT;
+        this->set_uniform_value("palettes", &palette_unit);
+
+        // every instance faces the same direction, as when the pose lived in the shared armature
+        static const float heading = float(rand() * M_PI);
+        this->pose = PoseManager::get().create_pose(this->mesh->get_armature());
+        this->pose->set_bone_transformation(2, glm::rotate(glm::mat4(1.0), (float)M_PI / 2.0f, glm::vec3(0,0,1)));
+        this->pose->set_bone_transformation(1, glm::rotate(glm::mat4(1.0), heading, glm::vec3(0,0,1)));
+        this->pose->evaluate();
+    }
+
+    this->flag_loaded = true;
 }
 
 /**
@@ -226,29 +255,59 @@ void Object::load() {
  * @param[in]  dt    time step
  */
 void Object::update(double dt) {
+    const unsigned int previous_lod = this->animation_lod;
+
+    if(!this->is_rigged || this->animation.get_clip() == NULL) {
+        this->animation_lod = ANIMATION_NONE;
+        return;
+    }
+
+    // the clip keeps playing while the pose is frozen, such that it stays in phase
+    this->animation.update(dt);
+    this->animation_lag += (float)dt;
 
+    const float interval = this->select_animation_interval();
+
+    if(interval < 0.0f) {
+        this->animation_lod = ANIMATION_NONE;
+        this->pose->set_interpolation(false);
+        return;
+    }
+
+    if(interval == 0.0f) {
+        this->animation_lod = ANIMATION_FULL;
+        this->pose->set_interpolation(false);
+        this->animation.apply(this->pose);
+        this->animation_lag = 0.0f;
+        return;
+    }
+
+    // show the pose one interval late, moving from the previous to the last sample
+    this->animation_lod = ANIMATION_PARTIAL;
+    if(this->animation_lag >= interval) {
+        // a frozen pose is not a sensible starting point
+        this->animation.apply(this->pose);
+        this->pose->set_interpolation(previous_lod != ANIMATION_NONE);
+        this->animation_lag = 0.0f;
+    }
+    this->pose->set_blend_weight(this->animation_lag / interval);
 }
 
-/**
- * @brief      add property to the object
- *
- * @param[in]  _name  name of the ObjectProperty
- * @param[in]  _type  variable type (derived from ShaderUniform types)
- * @param[in]  _size  size of the object
- *
- * @return     index of the ObjectProperty
- */
-unsigned int Object::add_property(const std::string& _name, unsigned int type, unsigned int size) {
-    this->properties.push_back(ObjectProperty(_name, type, size));
-    return this->properties.size() - 1;
+Object::~Object() {
+    if(this->pose) {
+        PoseManager::get().destroy_pose(this->pose);
+    }
 }
 
 /**
- * @brief      set the value of an ObjectProperty
+ * @brief      set the value of a uniform
  *
- * @param[in]  prop_id  index of the property
- * @param[in]  val      pointer to memory holding values
+ * @param[in]  name  name of the uniform
+ * @param[in]  val   pointer to memory holding values
  */
-void Object::set_property_value(unsigned int prop_id, const float* val) {
-    this->properties[prop_id].set_value(val);
+void Object::set_uniform_value(const std::string& name, const float* val) {
+    const int uniform_id = this->shader->get_uniform_id(name);
+    if(uniform_id >= 0) {
+        this->shader->store_uniform(&this->uniforms[0], uniform_id, val);
+    }
 }
@@ -30,76 +30,11 @@
 
 #include "core/shader.h"
 #include "core/mesh.h"
+#include "core/pose.h"
+#include "core/animation.h"
 #include "core/texture_manager.h"
 #include "environment/sky.h"
 
-/**
- * @brief      a property that will be parsed to the shader as a uniform
- */
-class ObjectProperty {
-public:
-    /**
-     * @brief      ObjectProperty constructor
-     *
-     * @param[in]  _name  The name
-     * @param[in]  _type  The type
-     * @param[in]  _size  The size
-     */
-    ObjectProperty(const std::string& _name, unsigned int _type, unsigned int _size);
-
-    /**
-     * @brief      Set the value of the ObjectProperty
-     *
-     * @param[in]  val   value to set
-     */
-    void set_value(const float* val);
-
-    /**
-     * @brief      get the value of the ObjectProperty
-     *
-     * @return     value
-     */
-    inline const float* get_value() const {
-        return &this->val[0];
-    }
-
-    /**
-     * @brief      get the name of the ObjectProperty
-     *
-     * @return     name
-     */
-    inline const std::string& get_name() const {
-        return this->name;
-    }
-
-    /**
-     * @brief      get the size of the object property
-     *
-     * @return     size
-     */
-    inline unsigned int get_size() const {
-        return this->size;
-    }
-
-    /**
-     * @brief      get the type of the object property
-     *
-     * @return     type
-     */
-    inline unsigned int get_type() const {
-        return this->type;
-    }
-
-private:
-    std::vector<float> val;         //!< vector holding values
-
-    unsigned int size;              //!< size of the object property
-    unsigned int base_size;         //!< size of the base variable (e.g. 16 for mat4 and 3 for vec3)
-
-    std::string name;               //!< name of the ObjectProperty
-    unsigned int type;              //!< type of the ObjectProperty (same types as ShaderUniform)
-};
-
 /**
  * @brief      Object class
  */
@@ -109,21 +44,25 @@ protected:
     const Mesh* mesh;               //!< pointer to mesh object
     int texture_id;                 //!< texture id
 
-    std::vector<ObjectProperty> properties;     //!< vector holding ObjectProperties
+    std::vector<float> uniforms;                //!< values of all uniforms, packed as laid out by the shader
+    int model_uniform;                          //!< uniform id of the model matrix (-1 if the shader has none)
 
     glm::mat4 scale;                            //!< scale matrix of the object
     glm::mat4 rotation;                         //!< rotation matrix of the object
     glm::vec3 position;                         //!< position matrix of the object
 
-    double angle;                               //!< to be removed
     bool is_rigged;                             //!< boolean whether object has an armature
-    unsigned int rig_idx;                       //!< index of ObjectProperty that represents the armature
+    Pose* pose;                                 //!< pose of the armature of this object (see PoseManager)
+    AnimationPlayer animation;                  //!< playback of an animation clip of the mesh
+    float animation_lag;                        //!< time since the pose was last sampled
+    unsigned int animation_lod;                 //!< how the pose was updated in the last update (ANIMATION_*)
+    bool flag_loaded;                           //!< whether the object is ready to be drawn
 
 public:
     /*
      * @brief      Object constructor
      */
-    Object() {}
+    Object() : model_uniform(-1), pose(NULL), animation_lag(0.0f), animation_lod(ANIMATION_NONE) {}
 
     /**
      * @brief      Object constructor
@@ -143,40 +82,90 @@ public:
     Object(Shader* shader, const Mesh* _mesh, int _texture_id);
 
     /**
-     * @brief      draw the object
+     * @brief      queue the object to be drawn on its own (see RenderQueue)
+     *
+     *             Only for shaders that take the model matrix as a uniform
+     *             (e.g. the terrain); objects with instanced shaders, which
+     *             includes all skinned objects, are drawn by InstanceBatch.
+     */
+    void submit();
+
+    /**
+     * @brief      draw a level of detail of the object
+     *
+     *             Called by the RenderQueue, which has bound the shader,
+     *             texture and mesh.
+     *
+     * @param[in]  lod   level of detail
+     */
+    void draw(unsigned int lod);
+
+    /**
+     * @brief      set the uniforms from the values of this object
+     *
+     *             The shader needs to be in use. The camera and lighting
+     *             come from the FrameConstants block. Objects in the same
+     *             InstanceBatch share all properties apart from the model
+     *             matrix, which is then an instance attribute.
+     *
+     * @param[in]  model  model matrix
+     */
+    void set_properties(const glm::mat4& model);
+
+    /**
+     * @brief      whether the object lies (partially) inside a view frustum
+     *
+     * @param[in]  view_projection  view-projection matrix
+     *
+     * @return     true if the sphere enclosing every pose intersects the frustum
+     */
+    bool is_visible(const glm::mat4& view_projection) const;
+
+    /**
+     * @brief      select the level of detail from the projected size of the object
+     *
+     * @param[in]  projection  projection matrix
+     *
+     * @return     level of detail
      */
-    void draw();
+    unsigned int select_lod(const glm::mat4& projection) const;
 
     /**
      * @brief      load the object into memory
+     *
+     *             Requires the mesh (and texture) to be loaded.
      */
     void load();
 
     /**
-     * @brief      update the object
+     * @brief      whether all assets of the object have been loaded
      *
-     * @param[in]  dt    time step
+     * @return     true if load can be called
      */
-    virtual void update(double dt);
+    bool assets_ready() const;
 
     /**
-     * @brief      add property to the object
-     *
-     * @param[in]  _name  name of the ObjectProperty
-     * @param[in]  _type  variable type (derived from ShaderUniform types)
-     * @param[in]  _size  size of the object
+     * @brief      whether the object is ready to be drawn
      *
-     * @return     index of the ObjectProperty
+     * @return     true if the object is loaded
      */
-    unsigned int add_property(const std::string& _name, unsigned int _type, unsigned int _size);
+    inline bool is_loaded() const {
+        return this->flag_loaded;
+    }
 
     /**
-     * @brief      set the value of an ObjectProperty
+     * @brief      update the object
      *
-     * @param[in]  prop_id  index of the property
-     * @param[in]  val      pointer to memory holding values
+     *             Objects are updated concurrently (see ObjectsEngine::update).
+     *             An update may only modify the object itself and its pose,
+     *             and may only read shared state such as the frame constants, meshes
+     *             and animation clips.
+     *
+     * @param[in]  dt    time step
      */
-    void set_property_value(unsigned int prop_id, const float* val);
+    virtual void update(double dt);
+
+    virtual ~Object();
 
     inline void set_position(glm::vec3 _position) {
         this->position = _position;
@@ -194,7 +183,84 @@ public:
         return this->position;
     }
 
+    inline glm::mat4 get_model_matrix() const {
+        return glm::translate(glm::mat4(1.0f), this->position) * this->rotation * this->scale;
+    }
+
+    inline const Mesh* get_mesh() const {
+        return this->mesh;
+    }
+
+    inline Shader* get_shader() const {
+        return this->shader;
+    }
+
+    inline int get_texture_id() const {
+        return this->texture_id;
+    }
+
+    /**
+     * @brief      get the bone palette of the pose
+     *
+     * @return     bone matrices (NULL if the object has no armature)
+     */
+    inline const glm::mat4* get_palette() const {
+        return this->is_rigged ? this->pose->get_palette() : NULL;
+    }
+
+    /**
+     * @brief      get the slice of the pose in the PaletteBuffer
+     *
+     * @return     index of the first bone (0 if the object has no armature)
+     */
+    inline unsigned int get_palette_offset() const {
+        return this->is_rigged ? this->pose->get_palette_offset() : 0;
+    }
+
+    /**
+     * @brief      get how the pose was updated in the last update
+     *
+     * @return     ANIMATION_NONE, ANIMATION_PARTIAL or ANIMATION_FULL
+     */
+    inline unsigned int get_animation_lod() const {
+        return this->animation_lod;
+    }
+
+    static constexpr float LOD_MAX_PIXEL_ERROR = 1.0f;  //!< largest allowed simplification error in pixels
+
+    static const unsigned int ANIMATION_NONE    = 0;    //!< pose is frozen (no animation or not visible)
+    static const unsigned int ANIMATION_PARTIAL = 1;    //!< pose is sampled at a reduced rate and interpolated in between
+    static const unsigned int ANIMATION_FULL    = 2;    //!< pose is sampled in every update
+
+    static constexpr float ANIMATION_FULL_RATE_PIXELS = 128.0f;     //!< projected size above which poses are sampled in every update
+    static constexpr float ANIMATION_MIN_INTERVAL = 1.0f / 30.0f;   //!< time between samples just below that size
+    static constexpr float ANIMATION_MAX_INTERVAL = 0.5f;           //!< longest time between samples of a visible pose
+
 private:
+    /**
+     * @brief      set the value of a uniform
+     *
+     * @param[in]  name  name of the uniform
+     * @param[in]  val   pointer to memory holding values
+     */
+    void set_uniform_value(const std::string& name, const float* val);
+
+    /**
+     * @brief      get the size of a model unit on the screen
+     *
+     * @param[in]  projection  projection matrix
+     *
+     * @return     pixels per model unit at the distance of the object
+     */
+    float get_pixels_per_unit(const glm::mat4& projection) const;
+
+    /**
+     * @brief      select the time between two samples of the pose
+     *
+     * @return     interval in seconds; 0 to sample in every update and
+     *             negative if the object is not visible
+     */
+    float select_animation_interval() const;
 
 };
 
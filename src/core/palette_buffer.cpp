@@ -0,0 +1,106 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "palette_buffer.h"
+
+/**
+ * @brief       palette buffer constructor
+ *
+ * @return      palette buffer instance
+ */
+PaletteBuffer::PaletteBuffer() {
+    // the buffer is created on the first upload, when a context exists
+    this->buffer = 0;
+    this->texture = 0;
+    this->capacity = 0;
+}
+
+/**
+ * @brief      start collecting the palettes of a new frame
+ */
+void PaletteBuffer::clear() {
+    this->texels.clear();
+    this->slices.clear();
+}
+
+/**
+ * @brief      add a palette to the buffer
+ *
+ * @param[in]  palette   pointer to the bone matrices
+ * @param[in]  nr_bones  number of bones
+ *
+ * @return     index of the first bone of the palette in the buffer
+ */
+unsigned int PaletteBuffer::add_palette(const glm::mat4* palette, unsigned int nr_bones) {
+    std::unordered_map<const glm::mat4*, unsigned int>::const_iterator it = this->slices.find(palette);
+    if(it != this->slices.end()) {
+        return it->second;
+    }
+
+    const unsigned int offset = this->get_nr_bones();
+    for(unsigned int i=0; i<nr_bones; i++) {
+        for(unsigned int j=0; j<TEXELS_PER_BONE; j++) {
+            this->texels.push_back(palette[i][j]);
+        }
+    }
+    this->slices.insert(std::make_pair(palette, offset));
+
+    return offset;
+}
+
+/**
+ * @brief      upload the collected palettes and bind the buffer texture
+ */
+void PaletteBuffer::upload() {
+    if(this->buffer == 0) {
+        glGenBuffers(1, &this->buffer);
+        glGenTextures(1, &this->texture);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, this->buffer);
+    const unsigned int nr_bones = this->get_nr_bones();
+    if(nr_bones > this->capacity) {
+        // grow geometrically, such that the texture is rarely reattached
+        this->capacity = std::max(nr_bones, 2 * this->capacity);
+        glBufferData(GL_TEXTURE_BUFFER, this->capacity * TEXELS_PER_BONE * sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+
+        GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_BUFFER, this->texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, this->buffer);
+    } else {
+        // orphan the storage of the previous frame instead of waiting for it
+        glBufferData(GL_TEXTURE_BUFFER, this->capacity * TEXELS_PER_BONE * sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+    }
+
+    if(!this->texels.empty()) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, this->texels.size() * sizeof(glm::vec4), &this->texels[0][0]);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_BUFFER, this->texture);
+}
+
+PaletteBuffer::~PaletteBuffer() {
+    if(this->buffer != 0) {
+        GLState::get().forget_texture(this->texture);
+        glDeleteTextures(1, &this->texture);
+        glDeleteBuffers(1, &this->buffer);
+    }
+}
@@ -0,0 +1,132 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _PALETTE_BUFFER_H
+#define _PALETTE_BUFFER_H
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <GL/glew.h>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "core/gl_state.h"
+
+/**
+ * @class PaletteBuffer class
+ *
+ * @brief collects the bone palettes of all objects in a single texture buffer
+ *
+ * The palettes are gathered once per frame and uploaded in one go. Every
+ * object refers to its palette by the index of its first bone (its slice),
+ * such that the bones no longer have to be set per draw call and skinned
+ * objects can be drawn instanced.
+ *
+ * Bones are stored as 3x4 affine matrices: three RGBA32F texels holding the
+ * first three columns, which the vertex shader fetches with texelFetch. In
+ * the row vector convention of the Armature the last column of a bone is
+ * always (0,0,0,1), so the shader restores it, and the skinned vertices are
+ * identical to those of full matrices at three quarters of the bandwidth.
+ */
+class PaletteBuffer {
+private:
+    GLuint buffer;                                              //!< OpenGL reference to the buffer object
+    GLuint texture;                                             //!< OpenGL reference to the buffer texture
+    unsigned int capacity;                                      //!< number of bones the buffer object can hold
+
+    std::vector<glm::vec4> texels;                              //!< columns of the palettes collected in this frame
+    std::unordered_map<const glm::mat4*, unsigned int> slices;  //!< first bone of every collected palette
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the palette buffer
+     *
+     * @return      reference to the palette buffer object (singleton pattern)
+     */
+    static PaletteBuffer& get() {
+        static PaletteBuffer palette_buffer_instance;
+        return palette_buffer_instance;
+    }
+
+    /**
+     * @brief      start collecting the palettes of a new frame
+     */
+    void clear();
+
+    /**
+     * @brief      add a palette to the buffer
+     *
+     *             Palettes that are shared by several poses (see PoseManager)
+     *             are stored once.
+     *
+     * @param[in]  palette   pointer to the bone matrices
+     * @param[in]  nr_bones  number of bones
+     *
+     * @return     index of the first bone of the palette in the buffer
+     */
+    unsigned int add_palette(const glm::mat4* palette, unsigned int nr_bones);
+
+    /**
+     * @brief      upload the collected palettes and bind the buffer texture
+     *             to TEXTURE_UNIT
+     */
+    void upload();
+
+    /**
+     * @brief      get the number of bones in the buffer
+     *
+     * @return     number of bones
+     */
+    inline unsigned int get_nr_bones() const {
+        return this->texels.size() / TEXELS_PER_BONE;
+    }
+
+    /**
+     * @brief      get the number of distinct palettes in the buffer
+     *
+     * @return     number of palettes
+     */
+    inline unsigned int get_nr_palettes() const {
+        return this->slices.size();
+    }
+
+    ~PaletteBuffer();
+
+    static const unsigned int TEXTURE_UNIT = 3;     //!< texture unit of the palettes (font writer and post processor use 1 and 2)
+    static const unsigned int TEXELS_PER_BONE = 3;  //!< number of columns stored per bone
+
+private:
+    /**
+     * @brief       palette buffer constructor
+     *
+     * @return      palette buffer instance
+     */
+    PaletteBuffer();
+
+    PaletteBuffer(PaletteBuffer const&)          = delete;
+    void operator=(PaletteBuffer const&)  = delete;
+};
+
+#endif // _PALETTE_BUFFER_H
@@ -0,0 +1,264 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "pose.h"
+
+/**
+ * @brief      Pose constructor
+ *
+ * @param[in]  _armature  skeleton the pose applies to
+ */
+Pose::Pose(const Armature* _armature) {
+    this->armature = _armature;
+    this->transformations.resize(_armature->get_nr_bones(), glm::mat4(1.0));
+    this->palette.resize(_armature->get_nr_bones(), glm::mat4(1.0));
+    this->shared = NULL;
+    this->flag_dirty = true;
+    this->blend_weight = 1.0f;
+    this->flag_interpolate = false;
+    this->flag_blended = false;
+    this->palette_offset = 0;
+}
+
+/**
+ * @brief      evaluate the palette of this pose immediately
+ */
+void Pose::evaluate() {
+    this->armature->evaluate(&this->transformations[0], &this->palette[0]);
+    this->shared = NULL;
+    this->flag_dirty = false;
+}
+
+/**
+ * @brief      keep the palette of the previous evaluation
+ *
+ * @param[in]  enable  whether to keep the history
+ */
+void Pose::set_interpolation(bool enable) {
+    this->flag_interpolate = enable;
+
+    if(enable) {
+        this->flag_dirty = true;
+    } else {
+        this->history.clear();
+        this->blend_weight = 1.0f;
+        this->flag_blended = false;
+    }
+}
+
+/**
+ * @brief      store the current palette before it changes
+ */
+void Pose::save_history() {
+    if(this->flag_interpolate) {
+        const glm::mat4* current = this->get_current_palette();
+        this->history.assign(current, current + this->palette.size());
+    }
+}
+
+/**
+ * @brief      build the blended palette
+ */
+void Pose::blend() {
+    // without a history there is nothing to interpolate from
+    this->flag_blended = this->flag_interpolate && !this->history.empty() && this->blend_weight < 1.0f;
+    if(!this->flag_blended) {
+        return;
+    }
+
+    const glm::mat4* current = this->get_current_palette();
+    this->blended.resize(this->palette.size());
+    for(unsigned int i=0; i<this->palette.size(); i++) {
+        this->blended[i] = this->history[i] * (1.0f - this->blend_weight) + current[i] * this->blend_weight;
+    }
+}
+
+/**
+ * @brief      hash of the skeleton and bone transformations
+ *
+ * @return     64 bit FNV-1a hash
+ */
+uint64_t Pose::hash() const {
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    const uintptr_t skeleton = (uintptr_t)this->armature;
+    const uint8_t* bytes = (const uint8_t*)&skeleton;
+    for(unsigned int i=0; i<sizeof(uintptr_t); i++) {
+        h = (h ^ bytes[i]) * 0x100000001b3ULL;
+    }
+
+    bytes = (const uint8_t*)&this->transformations[0];
+    for(unsigned int i=0; i<this->transformations.size() * sizeof(glm::mat4); i++) {
+        h = (h ^ bytes[i]) * 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+/**
+ * @brief      whether another pose has the same skeleton and transformations
+ *
+ * @param[in]  other  other pose
+ *
+ * @return     true if the palettes are identical
+ */
+bool Pose::equals(const Pose& other) const {
+    return this->armature == other.armature &&
+           std::memcmp(&this->transformations[0], &other.transformations[0], this->transformations.size() * sizeof(glm::mat4)) == 0;
+}
+
+/**
+ * @brief       pose manager constructor
+ *
+ * @return      pose manager instance
+ */
+PoseManager::PoseManager() {
+    this->nr_evaluated = 0;
+    this->nr_shared = 0;
+}
+
+/**
+ * @brief      create a pose in the rest position
+ *
+ * @param[in]  armature  skeleton the pose applies to
+ *
+ * @return     pointer to the pose
+ */
+Pose* PoseManager::create_pose(const Armature* armature) {
+    this->poses.push_back(new Pose(armature));
+    return this->poses.back();
+}
+
+/**
+ * @brief      destroy a pose
+ *
+ * @param[in]  pose  pointer to the pose
+ */
+void PoseManager::destroy_pose(const Pose* pose) {
+    for(unsigned int i=0; i<this->poses.size(); i++) {
+        // poses that share the palette of this pose evaluate their own on the next update
+        if(this->poses[i]->shared == pose) {
+            this->poses[i]->evaluate();
+        }
+    }
+
+    for(unsigned int i=0; i<this->poses.size(); i++) {
+        if(this->poses[i] == pose) {
+            delete this->poses[i];
+            this->poses.erase(this->poses.begin() + i);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief      evaluate every pose that changed
+ */
+void PoseManager::update() {
+    this->nr_evaluated = 0;
+    this->nr_shared = 0;
+
+    // poses that borrow a palette need a new one when the owner changes
+    for(unsigned int i=0; i<this->poses.size(); i++) {
+        if(this->poses[i]->shared && this->poses[i]->shared->flag_dirty) {
+            this->poses[i]->flag_dirty = true;
+        }
+    }
+
+    std::vector<Pose*> dirty;
+    for(unsigned int i=0; i<this->poses.size(); i++) {
+        if(this->poses[i]->flag_dirty) {
+            dirty.push_back(this->poses[i]);
+        }
+    }
+
+    // palettes change below; keep the ones that are interpolated from
+    std::vector<uint64_t> hashes(dirty.size());
+    JobSystem::get().parallel_for(dirty.size(), BATCH_SIZE, [&dirty, &hashes](unsigned int begin, unsigned int end) {
+        for(unsigned int i=begin; i<end; i++) {
+            dirty[i]->save_history();
+            hashes[i] = dirty[i]->hash();
+        }
+    });
+
+    // find identical poses in order, such that the same poses are evaluated
+    // regardless of the number of threads
+    std::unordered_multimap<uint64_t, Pose*> unique;
+    std::vector<Pose*> pending;
+
+    for(unsigned int i=0; i<dirty.size(); i++) {
+        Pose* pose = dirty[i];
+        std::pair<std::unordered_multimap<uint64_t, Pose*>::const_iterator,
+                  std::unordered_multimap<uint64_t, Pose*>::const_iterator> range = unique.equal_range(hashes[i]);
+
+        const Pose* original = NULL;
+        for(std::unordered_multimap<uint64_t, Pose*>::const_iterator it = range.first; it != range.second; ++it) {
+            if(it->second->equals(*pose)) {
+                original = it->second;
+                break;
+            }
+        }
+
+        if(original) {
+            pose->shared = original;
+            pose->flag_dirty = false;
+            this->nr_shared++;
+        } else {
+            unique.insert(std::make_pair(hashes[i], pose));
+            pending.push_back(pose);
+        }
+    }
+
+    JobSystem::get().parallel_for(pending.size(), BATCH_SIZE, [&pending](unsigned int begin, unsigned int end) {
+        for(unsigned int i=begin; i<end; i++) {
+            pending[i]->evaluate();
+        }
+    });
+    this->nr_evaluated = pending.size();
+
+    JobSystem::get().parallel_for(this->poses.size(), BATCH_SIZE, [this](unsigned int begin, unsigned int end) {
+        for(unsigned int i=begin; i<end; i++) {
+            if(this->poses[i]->flag_interpolate) {
+                this->poses[i]->blend();
+            }
+        }
+    });
+}
+
+/**
+ * @brief      write the palettes of all poses into the PaletteBuffer
+ */
+void PoseManager::upload_palettes() {
+    PaletteBuffer::get().clear();
+
+    // poses that share a palette also share its slice
+    for(unsigned int i=0; i<this->poses.size(); i++) {
+        this->poses[i]->palette_offset = PaletteBuffer::get().add_palette(this->poses[i]->get_palette(), this->poses[i]->get_nr_bones());
+    }
+
+    PaletteBuffer::get().upload();
+}
+
+PoseManager::~PoseManager() {
+    for(unsigned int i=0; i<this->poses.size(); i++) {
+        delete this->poses[i];
+    }
+}
@@ -0,0 +1,271 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _POSE_H
+#define _POSE_H
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "core/armature.h"
+#include "core/job_system.h"
+#include "core/palette_buffer.h"
+
+/**
+ * @brief      pose of a single object
+ *
+ * Holds the bone transformations set by the object and the bone palette
+ * that is sent to the shader. The skeleton itself (Armature) is shared by
+ * all objects that use the same mesh and is never modified.
+ */
+class Pose {
+private:
+    const Armature* armature;                       //!< skeleton the pose applies to
+    std::vector<glm::mat4> transformations;         //!< pose of every bone in its own space
+    std::vector<glm::mat4> palette;                 //!< vertex multiplication matrices
+    const Pose* shared;                             //!< identical pose whose palette is used (NULL if none)
+    bool flag_dirty;                                //!< whether the transformations changed since the last evaluation
+
+    std::vector<glm::mat4> history;                 //!< palette before the last evaluation (see set_interpolation)
+    std::vector<glm::mat4> blended;                 //!< palette between the history and the current palette
+    float blend_weight;                             //!< weight of the current palette in the blended palette
+    bool flag_interpolate;                          //!< whether the history is kept
+    bool flag_blended;                              //!< whether get_palette returns the blended palette
+
+    unsigned int palette_offset;                    //!< first bone of the palette in the PaletteBuffer
+
+    friend class PoseManager;
+
+public:
+    /**
+     * @brief      Pose constructor
+     *
+     * @param[in]  _armature  skeleton the pose applies to
+     */
+    Pose(const Armature* _armature);
+
+    /**
+     * @brief      set the transformation of a single bone
+     *
+     * @param[in]  idx   index of the bone
+     * @param[in]  m     transformation in the space of the bone
+     */
+    inline void set_bone_transformation(unsigned int idx, const glm::mat4& m) {
+        if(this->transformations[idx] != m) {
+            this->transformations[idx] = m;
+            this->flag_dirty = true;
+        }
+    }
+
+    /**
+     * @brief      evaluate the palette of this pose immediately
+     */
+    void evaluate();
+
+    /**
+     * @brief      keep the palette of the previous evaluation, such that a
+     *             pose that is evaluated at a low rate can be interpolated
+     *
+     *             Enabling marks the pose as changed, such that the history
+     *             moves along even if the new sample equals the last one.
+     *
+     * @param[in]  enable  whether to keep the history
+     */
+    void set_interpolation(bool enable);
+
+    /**
+     * @brief      set the position between the previous and the current
+     *             palette; the blended palette is built by PoseManager
+     *
+     * @param[in]  w     weight of the current palette (1.0 disables blending)
+     */
+    inline void set_blend_weight(float w) {
+        this->blend_weight = w;
+    }
+
+    /**
+     * @brief      get the bone palette
+     *
+     *             Points to the palette of an identical pose if there is one,
+     *             or to the interpolated palette.
+     *
+     * @return     pointer to get_nr_bones() matrices
+     */
+    inline const glm::mat4* get_palette() const {
+        return this->flag_blended ? &this->blended[0] : this->get_current_palette();
+    }
+
+    /**
+     * @brief      get the number of bones
+     *
+     * @return     number of bones
+     */
+    inline unsigned int get_nr_bones() const {
+        return this->transformations.size();
+    }
+
+    /**
+     * @brief      get the slice of the palette in the PaletteBuffer
+     *
+     *             Only valid after PoseManager::upload_palettes in the
+     *             current frame.
+     *
+     * @return     index of the first bone
+     */
+    inline unsigned int get_palette_offset() const {
+        return this->palette_offset;
+    }
+
+private:
+    /**
+     * @brief      get the palette of the last evaluation
+     *
+     * @return     pointer to get_nr_bones() matrices
+     */
+    inline const glm::mat4* get_current_palette() const {
+        return this->shared ? &this->shared->palette[0] : &this->palette[0];
+    }
+
+    /**
+     * @brief      store the current palette before it changes
+     */
+    void save_history();
+
+    /**
+     * @brief      build the blended palette
+     */
+    void blend();
+
+    /**
+     * @brief      hash of the skeleton and bone transformations
+     *
+     * @return     64 bit FNV-1a hash
+     */
+    uint64_t hash() const;
+
+    /**
+     * @brief      whether another pose has the same skeleton and transformations
+     *
+     * @param[in]  other  other pose
+     *
+     * @return     true if the palettes are identical
+     */
+    bool equals(const Pose& other) const;
+};
+
+/**
+ * @class PoseManager class
+ *
+ * @brief evaluates all poses in bulk
+ *
+ * Objects only write their bone transformations during their update. The
+ * poses that changed are evaluated afterwards in a single pass, in which
+ * identical poses are evaluated only once and share their palette; the cost
+ * of animation thus scales with the number of distinct poses. Hashing,
+ * evaluating and blending are spread over the JobSystem.
+ */
+class PoseManager {
+private:
+    std::vector<Pose*> poses;                       //!< all poses
+    unsigned int nr_evaluated;                      //!< number of palettes evaluated in the last update
+    unsigned int nr_shared;                         //!< number of poses that reused a palette in the last update
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the pose manager
+     *
+     * @return      reference to the pose manager object (singleton pattern)
+     */
+    static PoseManager& get() {
+        static PoseManager pose_manager_instance;
+        return pose_manager_instance;
+    }
+
+    /**
+     * @brief      create a pose in the rest position
+     *
+     * @param[in]  armature  skeleton the pose applies to
+     *
+     * @return     pointer to the pose
+     */
+    Pose* create_pose(const Armature* armature);
+
+    /**
+     * @brief      destroy a pose
+     *
+     * @param[in]  pose  pointer to the pose
+     */
+    void destroy_pose(const Pose* pose);
+
+    /**
+     * @brief      evaluate every pose that changed
+     */
+    void update();
+
+    /**
+     * @brief      write the palettes of all poses into the PaletteBuffer
+     *
+     *             Called once per frame on the render thread, after update.
+     */
+    void upload_palettes();
+
+    /**
+     * @brief      get the number of palettes evaluated in the last update
+     *
+     * @return     number of evaluated palettes
+     */
+    inline unsigned int get_nr_evaluated() const {
+        return this->nr_evaluated;
+    }
+
+    /**
+     * @brief      get the number of poses that reused a palette in the last update
+     *
+     * @return     number of shared palettes
+     */
+    inline unsigned int get_nr_shared() const {
+        return this->nr_shared;
+    }
+
+    ~PoseManager();
+
+    static const unsigned int BATCH_SIZE = 256;     //!< number of poses per job
+
+private:
+    /**
+     * @brief       pose manager constructor
+     *
+     * @return      pose manager instance
+     */
+    PoseManager();
+
+    PoseManager(PoseManager const&)          = delete;
+    void operator=(PoseManager const&)  = delete;
+};
+
+#endif // _POSE_H
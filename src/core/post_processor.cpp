@@ -31,8 +31,6 @@ PostProcessor::PostProcessor() {
     this->square_mesh.load_square_mesh();
     this->square_mesh.static_load();
 
-    glActiveTexture(GL_TEXTURE2);
-
     // msaa buffer
     this->create_msaa_buffer(&this->depth_msaa, &this->texture_msaa, &this->frame_buffer_msaa);
 
@@ -60,15 +58,15 @@ PostProcessor::PostProcessor() {
     this->shader_blur_v->set_uniform(3, &glm::vec2(0,1)[0]);
 
     // unbind vertex array
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
 }
 
 /**
  * @brief      bind the msaa frame buffer
  */
 void PostProcessor::bind_frame_buffer() {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->frame_buffer_msaa);
-    glEnable(GL_MULTISAMPLE);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, this->frame_buffer_msaa);
+    GLState::get().enable(GL_MULTISAMPLE);
     GLenum status;
     if ((status = glCheckFramebufferStatus(GL_FRAMEBUFFER)) != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "glCheckFramebufferStatus: error " << status << std::endl;
@@ -88,7 +86,7 @@ void PostProcessor::bind_frame_buffer() {
  * @brief      unbind all frame buffers
  */
 void PostProcessor::unbind_frame_buffer() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -117,7 +115,7 @@ void PostProcessor::window_reshape() {
     const float width = (float)Screen::get().get_width();
     this->shader_blur_h->set_uniform(1, &width);
 
-    this->shader_blur_h->link_shader();
+    this->shader_blur_v->link_shader();
     const float height = (float)Screen::get().get_height();
     this->shader_blur_v->set_uniform(1, &height);
 }
@@ -127,15 +125,21 @@ void PostProcessor::window_reshape() {
  */
 PostProcessor::~PostProcessor() {
     glDeleteRenderbuffers(1, &this->depth_p);
+    GLState::get().forget_texture(this->texture_p);
     glDeleteTextures(1, &this->texture_p);
+    GLState::get().forget_framebuffer(this->frame_buffer_p);
     glDeleteFramebuffers(1, &this->frame_buffer_p);
 
     glDeleteRenderbuffers(1, &this->depth_s);
+    GLState::get().forget_texture(this->texture_s);
     glDeleteTextures(1, &this->texture_s);
+    GLState::get().forget_framebuffer(this->frame_buffer_s);
     glDeleteFramebuffers(1, &this->frame_buffer_s);
 
     glDeleteRenderbuffers(1, &this->depth_msaa);
+    GLState::get().forget_texture(this->texture_msaa);
     glDeleteTextures(1, &this->texture_msaa);
+    GLState::get().forget_framebuffer(this->frame_buffer_msaa);
     glDeleteFramebuffers(1, &this->frame_buffer_msaa);
 }
 
@@ -143,10 +147,10 @@ PostProcessor::~PostProcessor() {
  * @brief      blit the content of the msaa fbo to the primary fbo
  */
 void PostProcessor::resample_buffer() {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->frame_buffer_msaa);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_p);
+    GLState::get().bind_framebuffer(GL_READ_FRAMEBUFFER, this->frame_buffer_msaa);
+    GLState::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_p);
     glBlitFramebuffer(0, 0, Screen::get().get_width(), Screen::get().get_height(), 0, 0, Screen::get().get_width(), Screen::get().get_height(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -169,13 +173,13 @@ void PostProcessor::apply_filters() {
  */
 void PostProcessor::pass(Shader* shader) {
     //set buffer (draw to passive buffer)
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_passive);
+    GLState::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_passive);
 
     // perform draw
     this->render(shader);
 
     // unset buffer
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
     // swap buffers
     this->swap_active_buffer();
@@ -221,21 +225,16 @@ void PostProcessor::swap_active_buffer() {
 void PostProcessor::render(Shader* shader) {
     glClearColor(0.0, 0.0, 0.0, 1.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, this->texture_active);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D, this->texture_active);
 
     this->square_mesh.bind();
 
     shader->link_shader();
     shader->set_uniform(0, NULL); // set texture id
 
+    // the texture and vertex array stay bound; the state cache skips rebinding them
     this->square_mesh.draw();
 
-    this->square_mesh.unbind();
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0);
 }
 
 /**
@@ -246,22 +245,20 @@ void PostProcessor::create_msaa_buffer(GLuint* render_buffer, GLuint* texture, G
     glBindRenderbuffer(GL_RENDERBUFFER, *render_buffer);
     glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->msaa, GL_DEPTH24_STENCIL8, Screen::get().get_width(), Screen::get().get_height());
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-    glActiveTexture(GL_TEXTURE2);
     glGenTextures(1, texture);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, *texture);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D_MULTISAMPLE, *texture);
     glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, this->msaa, GL_RGBA, Screen::get().get_width(), Screen::get().get_height(), GL_TRUE);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D_MULTISAMPLE, 0);
 
     glGenFramebuffers(1, frame_buffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, *frame_buffer);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, *frame_buffer);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, *texture, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, *render_buffer);
     GLenum status;
     if ((status = glCheckFramebufferStatus(GL_FRAMEBUFFER)) != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "glCheckFramebufferStatus: error " << status << std::endl;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -272,26 +269,24 @@ void PostProcessor::create_buffer(GLuint* render_buffer, GLuint* texture, GLuint
     glBindRenderbuffer(GL_RENDERBUFFER, *render_buffer);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, Screen::get().get_width(), Screen::get().get_height());
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-    glActiveTexture(GL_TEXTURE2);
     glGenTextures(1, texture);
-    glBindTexture(GL_TEXTURE_2D, *texture);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D, *texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Screen::get().get_width(), Screen::get().get_height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D, 0);
 
     glGenFramebuffers(1, frame_buffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, *frame_buffer);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, *frame_buffer);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, *texture, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, *render_buffer);
     GLenum status;
     if ((status = glCheckFramebufferStatus(GL_FRAMEBUFFER)) != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "glCheckFramebufferStatus: error " << status << std::endl;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -299,10 +294,9 @@ void PostProcessor::create_buffer(GLuint* render_buffer, GLuint* texture, GLuint
  */
 void PostProcessor::set_msaa_buffer(GLuint texture, GLuint frame_buffer) {
     // resize regular buffer
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, texture);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D_MULTISAMPLE, texture);
     glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, this->msaa, GL_RGBA, Screen::get().get_width(), Screen::get().get_height(), GL_TRUE);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D_MULTISAMPLE, 0);
 
     glBindRenderbuffer(GL_RENDERBUFFER, frame_buffer);
     glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->msaa, GL_DEPTH24_STENCIL8, Screen::get().get_width(), Screen::get().get_height());
@@ -313,10 +307,9 @@ void PostProcessor::set_msaa_buffer(GLuint texture, GLuint frame_buffer) {
  * @brief      set with and height to regular buffers
  */
 void PostProcessor::set_buffer(GLuint texture, GLuint frame_buffer) {
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D, texture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Screen::get().get_width(), Screen::get().get_height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D, 0);
 
     glBindRenderbuffer(GL_RENDERBUFFER, frame_buffer);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, Screen::get().get_width(), Screen::get().get_height());
@@ -330,7 +323,7 @@ void PostProcessor::create_shader(Shader*& shader, const std::string& filename)
     shader = new Shader(filename);
     shader->add_attribute(ShaderAttribute::POSITION, "position");
     shader->add_uniform(ShaderUniform::TEXTURE, "text", 1);
-    shader->set_texture_id(2); // corresponds to GL_TEXTURE2
+    shader->set_texture_id(TEXTURE_UNIT);
 
     if(filename.compare("assets/filters/blur") == 0) {
         shader->add_uniform(ShaderUniform::FLOAT, "resolution", 1);
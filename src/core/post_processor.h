@@ -84,6 +84,8 @@ public:
     static const unsigned int FILTER_BLUR = 1 << 0;
     static const unsigned int FILTER_INVERT = 1 << 1;
 
+    static const unsigned int TEXTURE_UNIT = 2;     //!< texture unit of the frame buffer textures
+
     /**
      * @brief       enables a filter
      *
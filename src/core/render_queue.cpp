@@ -0,0 +1,255 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "render_queue.h"
+#include "core/object.h"
+#include "core/instance_batch.h"
+#include "core/texture_manager.h"
+
+/**
+ * @brief       render queue constructor
+ *
+ * @return      render queue instance
+ */
+RenderQueue::RenderQueue() {
+    this->nr_packets = 0;
+    this->nr_program_switches = 0;
+    this->nr_texture_switches = 0;
+    this->nr_vao_switches = 0;
+}
+
+/**
+ * @brief      queue an object that is drawn on its own
+ *
+ * @param      object  the object
+ * @param[in]  lod     level of detail
+ * @param[in]  pass    render pass (PASS_*)
+ * @param[in]  depth   distance to the camera
+ */
+void RenderQueue::submit(Object* object, unsigned int lod, unsigned int pass, float depth) {
+    RenderPacket packet;
+    packet.shader = object->get_shader();
+    packet.texture_id = object->get_texture_id();
+    packet.mesh = object->get_mesh();
+    packet.object = object;
+    packet.batch = NULL;
+    packet.lod = lod;
+
+    this->push(packet, pass, depth);
+}
+
+/**
+ * @brief      queue a level of detail of an instance batch
+ *
+ * @param      batch   the batch
+ * @param[in]  lod     level of detail
+ * @param[in]  pass    render pass (PASS_*)
+ * @param[in]  depth   distance of the nearest instance to the camera
+ */
+void RenderQueue::submit(InstanceBatch* batch, unsigned int lod, unsigned int pass, float depth) {
+    RenderPacket packet;
+    packet.shader = batch->get_shader();
+    packet.texture_id = batch->get_texture_id();
+    packet.mesh = batch->get_mesh();
+    packet.object = NULL;
+    packet.batch = batch;
+    packet.lod = lod;
+
+    this->push(packet, pass, depth);
+}
+
+/**
+ * @brief      sort and draw all queued packets and empty the queue
+ */
+void RenderQueue::execute() {
+    this->sort();
+
+    this->nr_packets = this->packets.size();
+    this->nr_program_switches = 0;
+    this->nr_texture_switches = 0;
+    this->nr_vao_switches = 0;
+
+    // state is compared by resource rather than by key, as keys may wrap around
+    Shader* shader = NULL;
+    int texture_id = -1;
+    const Mesh* mesh = NULL;
+
+    for(unsigned int i=0; i<this->order.size(); i++) {
+        const RenderPacket& packet = this->packets[this->order[i]];
+
+        if(packet.shader != shader) {
+            shader = packet.shader;
+            shader->link_shader();
+            this->nr_program_switches++;
+        }
+
+        if(packet.texture_id > -1 && packet.texture_id != texture_id) {
+            texture_id = packet.texture_id;
+            TextureManager::get().bind_texture(texture_id);
+            this->nr_texture_switches++;
+        }
+
+        if(packet.mesh != mesh) {
+            mesh = packet.mesh;
+            mesh->bind();
+            this->nr_vao_switches++;
+        }
+
+        if(packet.batch != NULL) {
+            packet.batch->draw(packet.lod);
+        } else {
+            packet.object->draw(packet.lod);
+        }
+    }
+
+    if(mesh != NULL) {
+        mesh->unbind();
+    }
+
+    this->packets.clear();
+}
+
+/**
+ * @brief      add a packet and compose its key
+ *
+ * @param[in]  packet  the packet (without key)
+ * @param[in]  pass    render pass
+ * @param[in]  depth   distance to the camera
+ */
+void RenderQueue::push(RenderPacket packet, unsigned int pass, float depth) {
+    // the bits of a non-negative float increase with its value
+    uint32_t bits = 0;
+    const float d = std::max(depth, 0.0f);
+    std::memcpy(&bits, &d, sizeof(float));
+    uint64_t depth_key = bits >> (32 - DEPTH_BITS);
+    if(pass == PASS_TRANSPARENT) {
+        depth_key = ~depth_key & ((1 << DEPTH_BITS) - 1);
+    }
+
+    const uint64_t texture_key = (packet.texture_id + 1) & ((1 << TEXTURE_BITS) - 1);
+
+    packet.key = ((uint64_t)pass << (SHADER_BITS + TEXTURE_BITS + MESH_BITS + DEPTH_BITS)) |
+                 ((uint64_t)get_id(this->shader_ids, this->free_shader_ids, packet.shader, SHADER_BITS) << (TEXTURE_BITS + MESH_BITS + DEPTH_BITS)) |
+                 (texture_key << (MESH_BITS + DEPTH_BITS)) |
+                 ((uint64_t)get_id(this->mesh_ids, this->free_mesh_ids, packet.mesh, MESH_BITS) << DEPTH_BITS) |
+                 depth_key;
+
+    this->packets.push_back(packet);
+}
+
+/**
+ * @brief      forget the key of a shader or mesh that is about to be
+ *             deleted, such that the key can be handed out again
+ *
+ * @param[in]  resource  pointer to the shader or mesh
+ */
+void RenderQueue::release(const void* resource) {
+    release_id(this->shader_ids, this->free_shader_ids, resource);
+    release_id(this->mesh_ids, this->free_mesh_ids, resource);
+}
+
+/**
+ * @brief      get the key of a shader or mesh
+ *
+ * @param      ids       keys handed out so far
+ * @param      free_ids  keys of released resources
+ * @param[in]  resource  pointer to the shader or mesh
+ * @param[in]  bits      width of the field in the key
+ *
+ * @return     key of the resource
+ */
+unsigned int RenderQueue::get_id(std::unordered_map<const void*, unsigned int>& ids, std::vector<unsigned int>& free_ids, const void* resource, unsigned int bits) {
+    std::unordered_map<const void*, unsigned int>::const_iterator got = ids.find(resource);
+    if(got != ids.end()) {
+        return got->second;
+    }
+
+    // without released keys, the keys 0 .. ids.size() - 1 are in use
+    unsigned int id;
+    if(!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = ids.size() & ((1 << bits) - 1);
+    }
+    ids.emplace(resource, id);
+
+    return id;
+}
+
+/**
+ * @brief      remove the key of a resource and keep it for reuse
+ *
+ * @param      ids       keys handed out so far
+ * @param      free_ids  keys of released resources
+ * @param[in]  resource  pointer to the shader or mesh
+ */
+void RenderQueue::release_id(std::unordered_map<const void*, unsigned int>& ids, std::vector<unsigned int>& free_ids, const void* resource) {
+    std::unordered_map<const void*, unsigned int>::iterator got = ids.find(resource);
+    if(got != ids.end()) {
+        free_ids.push_back(got->second);
+        ids.erase(got);
+    }
+}
+
+/**
+ * @brief      sort the packets by key (least significant digit radix sort
+ *             on bytes)
+ */
+void RenderQueue::sort() {
+    const unsigned int n = this->packets.size();
+
+    this->order.resize(n);
+    this->scratch.resize(n);
+    for(unsigned int i=0; i<n; i++) {
+        this->order[i] = i;
+    }
+
+    for(unsigned int shift=0; shift<64; shift+=8) {
+        unsigned int count[257] = {0};
+        for(unsigned int i=0; i<n; i++) {
+            count[((this->packets[i].key >> shift) & 0xFF) + 1]++;
+        }
+
+        // a byte shared by all keys does not change the order
+        bool constant = false;
+        for(unsigned int b=1; b<257; b++) {
+            if(count[b] == n) {
+                constant = true;
+                break;
+            }
+        }
+        if(constant) {
+            continue;
+        }
+
+        for(unsigned int b=1; b<257; b++) {
+            count[b] += count[b-1];
+        }
+
+        // stable scatter, such that the lower bytes keep their order
+        for(unsigned int i=0; i<n; i++) {
+            const unsigned int idx = this->order[i];
+            this->scratch[count[(this->packets[idx].key >> shift) & 0xFF]++] = idx;
+        }
+        this->order.swap(this->scratch);
+    }
+}
@@ -0,0 +1,226 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _RENDER_QUEUE_H
+#define _RENDER_QUEUE_H
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "core/shader.h"
+#include "core/mesh.h"
+
+class Object;
+class InstanceBatch;
+
+/**
+ * @brief      a single draw in the render queue
+ */
+struct RenderPacket {
+    uint64_t key;               //!< sort key (pass, shader, texture, mesh and depth)
+    Shader* shader;             //!< shader program
+    int texture_id;             //!< texture (-1 if none)
+    const Mesh* mesh;           //!< mesh providing the vertex array
+    Object* object;             //!< object drawn on its own (NULL for a batch)
+    InstanceBatch* batch;       //!< instances drawn at once (NULL for a single object)
+    unsigned int lod;           //!< level of detail
+};
+
+/**
+ * @class RenderQueue class
+ *
+ * @brief collects the draws of a frame and executes them with as few state
+ *        changes as possible
+ *
+ * Every packet carries a 64 bit key, from the most to the least significant
+ * bits: the pass, the shader, the texture, the mesh and the depth. The keys
+ * are radix sorted, after which the program, texture and vertex array are
+ * only bound when they differ from those of the previous packet. Within a
+ * pass opaque draws run front to back, such that the depth test rejects
+ * hidden fragments early.
+ */
+class RenderQueue {
+private:
+    std::vector<RenderPacket> packets;                          //!< packets submitted in this frame
+    std::vector<unsigned int> order;                            //!< packets sorted by key
+    std::vector<unsigned int> scratch;                          //!< buffer for the radix sort
+
+    std::unordered_map<const void*, unsigned int> shader_ids;   //!< key of every shader
+    std::unordered_map<const void*, unsigned int> mesh_ids;     //!< key of every mesh
+    std::vector<unsigned int> free_shader_ids;                  //!< keys of deleted shaders
+    std::vector<unsigned int> free_mesh_ids;                    //!< keys of deleted meshes
+
+    unsigned int nr_packets;                                    //!< number of packets in the last frame
+    unsigned int nr_program_switches;                           //!< number of programs bound in the last frame
+    unsigned int nr_texture_switches;                           //!< number of textures bound in the last frame
+    unsigned int nr_vao_switches;                               //!< number of vertex arrays bound in the last frame
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the render queue
+     *
+     * @return      reference to the render queue object (singleton pattern)
+     */
+    static RenderQueue& get() {
+        static RenderQueue render_queue_instance;
+        return render_queue_instance;
+    }
+
+    /**
+     * @brief      queue an object that is drawn on its own
+     *
+     * @param      object  the object
+     * @param[in]  lod     level of detail
+     * @param[in]  pass    render pass (PASS_*)
+     * @param[in]  depth   distance to the camera
+     */
+    void submit(Object* object, unsigned int lod, unsigned int pass, float depth);
+
+    /**
+     * @brief      queue a level of detail of an instance batch
+     *
+     * @param      batch   the batch
+     * @param[in]  lod     level of detail
+     * @param[in]  pass    render pass (PASS_*)
+     * @param[in]  depth   distance of the nearest instance to the camera
+     */
+    void submit(InstanceBatch* batch, unsigned int lod, unsigned int pass, float depth);
+
+    /**
+     * @brief      sort and draw all queued packets and empty the queue
+     */
+    void execute();
+
+    /**
+     * @brief      forget the key of a shader or mesh that is about to be
+     *             deleted, such that the key can be handed out again
+     *
+     * @param[in]  resource  pointer to the shader or mesh
+     */
+    void release(const void* resource);
+
+    /**
+     * @brief      get the number of packets drawn in the last frame
+     *
+     * @return     number of packets
+     */
+    inline unsigned int get_nr_packets() const {
+        return this->nr_packets;
+    }
+
+    /**
+     * @brief      get the number of times a program was bound in the last frame
+     *
+     * @return     number of program switches
+     */
+    inline unsigned int get_nr_program_switches() const {
+        return this->nr_program_switches;
+    }
+
+    /**
+     * @brief      get the number of times a texture was bound in the last frame
+     *
+     * @return     number of texture switches
+     */
+    inline unsigned int get_nr_texture_switches() const {
+        return this->nr_texture_switches;
+    }
+
+    /**
+     * @brief      get the number of times a vertex array was bound in the last frame
+     *
+     * @return     number of vertex array switches
+     */
+    inline unsigned int get_nr_vao_switches() const {
+        return this->nr_vao_switches;
+    }
+
+    static const unsigned int PASS_OPAQUE       = 0;    //!< opaque geometry, front to back
+    static const unsigned int PASS_TRANSPARENT  = 1;    //!< blended geometry, back to front
+
+    static const unsigned int PASS_BITS     = 4;        //!< bits of the pass in the key
+    static const unsigned int SHADER_BITS   = 12;       //!< bits of the shader in the key
+    static const unsigned int TEXTURE_BITS  = 12;       //!< bits of the texture in the key
+    static const unsigned int MESH_BITS     = 12;       //!< bits of the mesh in the key
+    static const unsigned int DEPTH_BITS    = 24;       //!< bits of the depth in the key
+
+private:
+    /**
+     * @brief       render queue constructor
+     *
+     * @return      render queue instance
+     */
+    RenderQueue();
+
+    /**
+     * @brief      add a packet and compose its key
+     *
+     * @param[in]  packet  the packet (without key)
+     * @param[in]  pass    render pass
+     * @param[in]  depth   distance to the camera
+     */
+    void push(RenderPacket packet, unsigned int pass, float depth);
+
+    /**
+     * @brief      get the key of a shader or mesh
+     *
+     *             Keys of released resources are reused first; otherwise
+     *             keys are handed out in the order of first submission and
+     *             wrap around when the field is full, which only affects
+     *             the order of the packets and not their correctness.
+     *
+     * @param      ids       keys handed out so far
+     * @param      free_ids  keys of released resources
+     * @param[in]  resource  pointer to the shader or mesh
+     * @param[in]  bits      width of the field in the key
+     *
+     * @return     key of the resource
+     */
+    static unsigned int get_id(std::unordered_map<const void*, unsigned int>& ids, std::vector<unsigned int>& free_ids, const void* resource, unsigned int bits);
+
+    /**
+     * @brief      remove the key of a resource and keep it for reuse
+     *
+     * @param      ids       keys handed out so far
+     * @param      free_ids  keys of released resources
+     * @param[in]  resource  pointer to the shader or mesh
+     */
+    static void release_id(std::unordered_map<const void*, unsigned int>& ids, std::vector<unsigned int>& free_ids, const void* resource);
+
+    /**
+     * @brief      sort the packets by key (least significant digit radix
+     *             sort on bytes)
+     */
+    void sort();
+
+    RenderQueue(RenderQueue const&)          = delete;
+    void operator=(RenderQueue const&)  = delete;
+};
+
+#endif // _RENDER_QUEUE_H
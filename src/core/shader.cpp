@@ -19,36 +19,74 @@
 #**************************************************************************/
 
 #include "shader.h"
+#include "core/frame_constants.h"
 
 // create an empty shader
 static GLuint create_shader(const std::string &text, GLenum shader_type);
 
-// load a shader from a file
+// load a shader from a file, inserting the files named by #include "file" lines
 static std::string load_shader(const std::string& filename);
 
 // check the shader for errors
 static void check_shader_error(GLuint shader, GLuint flag, bool is_program, const std::string& error_message);
 
+size_t Shader::uniform_bytes_uploaded = 0;
+size_t Shader::uniform_bytes_skipped = 0;
+size_t Shader::uniform_bytes_uploaded_last_frame = 0;
+size_t Shader::uniform_bytes_skipped_last_frame = 0;
+
 ShaderUniform::ShaderUniform(unsigned int _type, const std::string& _name, unsigned int _size) {
     this->type = _type;
     this->name = _name;
     this->size = _size;
 }
 
+// number of floats of a single element of a uniform type
+unsigned int ShaderUniform::get_base_size(unsigned int type) {
+    switch(type) {
+        case ShaderUniform::MAT4:
+        case ShaderUniform::FRAME_MATRIX:
+        case ShaderUniform::OFFSET_MATRIX:
+            return 16;
+        case ShaderUniform::VEC4:
+            return 4;
+        case ShaderUniform::VEC3:
+            return 3;
+        case ShaderUniform::VEC2:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
 ShaderAttribute::ShaderAttribute(unsigned int _type, const std::string& _name) {
     this->type = _type;
     this->name = _name;
 }
 
 Shader::Shader(const std::string& filename) {
+    this->load_record = LoadStatistics::get().add_record("shader", filename);
+
     // constructs the program
     this->m_program = glCreateProgram();
 
-    // set vertex shader
-    this->m_shaders[0] = create_shader(load_shader(filename + ".vs"), GL_VERTEX_SHADER);
+    std::string sources[NUM_SHADERS];
+    {
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_READ);
+        sources[0] = load_shader(filename + ".vs");
+        sources[1] = load_shader(filename + ".fs");
+    }
+    LoadStatistics::get().add_bytes_read(this->load_record, sources[0].size() + sources[1].size());
 
-    // set fragment shader
-    this->m_shaders[1] = create_shader(load_shader(filename + ".fs"), GL_FRAGMENT_SHADER);
+    {
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_PROCESS);
+
+        // set vertex shader
+        this->m_shaders[0] = create_shader(sources[0], GL_VERTEX_SHADER);
+
+        // set fragment shader
+        this->m_shaders[1] = create_shader(sources[1], GL_FRAGMENT_SHADER);
+    }
 
     // attach all shaders
     for(unsigned int i = 0; i < NUM_SHADERS; i++) {
@@ -57,10 +95,15 @@ Shader::Shader(const std::string& filename) {
 
     this->flag_loaded = false;
     this->texture_id = 0;
+    this->nr_uniform_floats = 0;
 }
 
 void Shader::add_uniform(unsigned int type, std::string name, unsigned int size) {
     this->shader_uniforms.push_back(ShaderUniform(type, name, size));
+
+    // values are packed as glUniform* reads them; textures keep a slot but are set from the texture unit
+    this->uniform_offsets.push_back(this->nr_uniform_floats);
+    this->nr_uniform_floats += ShaderUniform::get_base_size(type) * size;
 }
 
 void Shader::add_attribute(unsigned int type, const std::string& name) {
@@ -68,6 +111,8 @@ void Shader::add_attribute(unsigned int type, const std::string& name) {
 }
 
 void Shader::bind_uniforms_and_attributes() {
+    LoadTimer timer(this->load_record, LoadStatistics::PHASE_UPLOAD);
+
     for(unsigned int i=0; i<this->shader_attributes.size(); i++) {
         glBindAttribLocation(this->m_program, i, shader_attributes[i].get_name().c_str());
     }
@@ -80,18 +125,47 @@ void Shader::bind_uniforms_and_attributes() {
     glValidateProgram(this->m_program);
     check_shader_error(m_program, GL_VALIDATE_STATUS, true, "Error: Program validation failed: ");
 
-    glUseProgram(this->m_program);
+    GLState::get().use_program(this->m_program);
+
+    // shaders that declare the block read the constants of the current frame
+    const GLuint block_index = glGetUniformBlockIndex(this->m_program, FrameConstants::BLOCK_NAME);
+    if(block_index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(this->m_program, block_index, FrameConstants::BINDING_POINT);
+    }
 
     m_uniforms.resize(shader_uniforms.size());
     for(unsigned int i=0; i<this->shader_uniforms.size(); i++) {
         m_uniforms[i] = glGetUniformLocation(this->m_program, shader_uniforms[i].get_name().c_str());
     }
 
+    // room for the last value of every uniform; linking resets all values
+    this->uniform_values.assign(this->nr_uniform_floats, 0.0f);
+    this->uniform_uploaded.assign(this->shader_uniforms.size(), false);
+
     this->flag_loaded = true;
 }
 
 void Shader::set_uniform(unsigned int uniform_id, const float* val) {
-    switch(this->shader_uniforms[uniform_id].get_type()) {
+    const ShaderUniform& uniform = this->shader_uniforms[uniform_id];
+
+    // textures read the unit of the shader instead of a value
+    const float texture_unit = (float)this->texture_id;
+    if(uniform.get_type() == ShaderUniform::TEXTURE) {
+        val = &texture_unit;
+    }
+
+    // uniforms keep their value in the program, so unchanged values need not be sent again
+    const size_t bytes = ShaderUniform::get_base_size(uniform.get_type()) * uniform.get_size() * sizeof(float);
+    float* shadow = &this->uniform_values[this->uniform_offsets[uniform_id]];
+    if(this->uniform_uploaded[uniform_id] && std::memcmp(shadow, val, bytes) == 0) {
+        uniform_bytes_skipped += bytes;
+        return;
+    }
+    std::memcpy(shadow, val, bytes);
+    this->uniform_uploaded[uniform_id] = true;
+    uniform_bytes_uploaded += bytes;
+
+    switch(uniform.get_type()) {
         case ShaderUniform::MAT4:
             glUniformMatrix4fv(m_uniforms[uniform_id], this->shader_uniforms[uniform_id].get_size(), GL_FALSE, val);
         break;
@@ -116,14 +190,45 @@ void Shader::set_uniform(unsigned int uniform_id, const float* val) {
         case  ShaderUniform::OFFSET_MATRIX:
             glUniformMatrix4fv(m_uniforms[uniform_id], this->shader_uniforms[uniform_id].get_size(), GL_FALSE, val);
         break;
+        case  ShaderUniform::INT:
+            glUniform1i(m_uniforms[uniform_id], (GLint)val[0]);
+        break;
         default:
             // do nothing
         break;
     }
 }
 
+int Shader::get_uniform_id(const std::string& name) const {
+    for(unsigned int i=0; i<this->shader_uniforms.size(); i++) {
+        if(this->shader_uniforms[i].get_name() == name) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void Shader::store_uniform(float* values, unsigned int uniform_id, const float* val) const {
+    const ShaderUniform& uniform = this->shader_uniforms[uniform_id];
+    std::memcpy(values + this->uniform_offsets[uniform_id], val, ShaderUniform::get_base_size(uniform.get_type()) * uniform.get_size() * sizeof(float));
+}
+
+void Shader::set_uniforms(const float* values) {
+    for(unsigned int i=0; i<this->shader_uniforms.size(); i++) {
+        this->set_uniform(i, values + this->uniform_offsets[i]);
+    }
+}
+
+void Shader::new_frame() {
+    uniform_bytes_uploaded_last_frame = uniform_bytes_uploaded;
+    uniform_bytes_skipped_last_frame = uniform_bytes_skipped;
+    uniform_bytes_uploaded = 0;
+    uniform_bytes_skipped = 0;
+}
+
 void Shader::link_shader() {
-    glUseProgram(this->m_program);
+    GLState::get().use_program(this->m_program);
 }
 
 /*
@@ -138,6 +243,7 @@ Shader::~Shader() {
     }
 
     // finally delete the program
+    GLState::get().forget_program(this->m_program);
     glDeleteProgram(this->m_program);
 }
 
@@ -169,10 +275,20 @@ static std::string load_shader(const std::string& filename) {
     std::string output;
     std::string line;
 
+    // included files are looked up next to the including file
+    static const boost::regex include_line("^\\s*#include\\s+\"([^\"]+)\"\\s*$");
+    const std::string directory = filename.substr(0, filename.find_last_of('/') + 1);
+
     if(file.is_open()) {
         while(file.good()) {
             getline(file, line);
-            output.append(line + "\n");
+
+            boost::smatch what;
+            if(boost::regex_match(line, what, include_line)) {
+                output.append(load_shader(directory + what[1].str()));
+            } else {
+                output.append(line + "\n");
+            }
         }
     } else {
         std::cerr << "Unable to load shader: " << filename << std::endl;
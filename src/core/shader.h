@@ -25,9 +25,13 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
+#include <cstring>
 #include <GL/glew.h>
+#include <boost/regex.hpp>
 
 #include "camera.h"
+#include "gl_state.h"
+#include "load_statistics.h"
 
 class ShaderUniform {
 public:
@@ -49,6 +53,8 @@ public:
         return this->size;
     }
 
+    static unsigned int get_base_size(unsigned int type);
+
     enum {
         MAT4,
         VEC4,
@@ -59,6 +65,7 @@ public:
         FLOAT,
         FRAME_MATRIX,
         OFFSET_MATRIX,
+        INT,
 
         NUM_VAR_TYPES
     };
@@ -73,12 +80,17 @@ class ShaderAttribute {
 public:
     ShaderAttribute(unsigned int _type, const std::string& _name);
 
+    // for objects, the type doubles as vertex attribute location (see Object::load);
+    // the instance matrix takes four locations and therefore comes last
     enum {
         POSITION,
         NORMAL,
         COLOR,
         TEXTURE_COORDINATE,
         WEIGHT,
+        BONE_INDEX,
+        INSTANCE_PALETTE_OFFSET,
+        INSTANCE_MODEL,
 
         NUM_ATTR_TYPES
     };
@@ -108,6 +120,20 @@ public:
 
     void set_uniform(unsigned int uniform_id, const float* val);
 
+    // find a uniform by name (-1 if the shader has no such uniform)
+    int get_uniform_id(const std::string& name) const;
+
+    // number of floats of the values of all uniforms
+    inline unsigned int get_nr_uniform_floats() const {
+        return this->nr_uniform_floats;
+    }
+
+    // copy the value of a uniform into an array holding the values of all uniforms
+    void store_uniform(float* values, unsigned int uniform_id, const float* val) const;
+
+    // set all uniforms from an array holding their values
+    void set_uniforms(const float* values);
+
     void link_shader();
 
     inline bool is_loaded() const {
@@ -118,6 +144,19 @@ public:
         this->texture_id = _texture_id;
     }
 
+    // start counting the uniform uploads of a new frame
+    static void new_frame();
+
+    // bytes sent with glUniform* in the last frame
+    static inline size_t get_uniform_bytes_uploaded() {
+        return uniform_bytes_uploaded_last_frame;
+    }
+
+    // bytes of uniforms that already had their value in the last frame
+    static inline size_t get_uniform_bytes_skipped() {
+        return uniform_bytes_skipped_last_frame;
+    }
+
     virtual ~Shader();
 
 protected:
@@ -135,8 +174,20 @@ private:
     std::vector<ShaderUniform> shader_uniforms; //<! vector holding shader uniforms
     std::vector<GLuint> m_uniforms;             // reference array to the uniforms
 
+    std::vector<unsigned int> uniform_offsets;  //<! first float of every uniform in an array of all values
+    unsigned int nr_uniform_floats;             //<! number of floats of the values of all uniforms
+
+    std::vector<float> uniform_values;          //<! last uploaded value of every uniform (shadow copy)
+    std::vector<bool> uniform_uploaded;         //<! whether a uniform has been set since linking
+
+    static size_t uniform_bytes_uploaded;                   //<! bytes sent in this frame
+    static size_t uniform_bytes_skipped;                    //<! bytes skipped in this frame
+    static size_t uniform_bytes_uploaded_last_frame;        //<! bytes sent in the last frame
+    static size_t uniform_bytes_skipped_last_frame;         //<! bytes skipped in the last frame
+
     bool flag_loaded;
     GLuint texture_id;
+    unsigned int load_record;                   // record in LoadStatistics
 };
 
 #endif //_SHADER_H
@@ -0,0 +1,145 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "skinning.h"
+
+// product of a row vector and a matrix given by its rows; the components of
+// the vector are accumulated in the order x, y, z, w
+static inline float4 multiply_rows(const glm::vec4& v, const glm::mat4& rows) {
+    float4 r = f4_mul(f4_set(v.x), f4_load(&rows[0][0]));
+    r = f4_add(r, f4_mul(f4_set(v.y), f4_load(&rows[1][0])));
+    r = f4_add(r, f4_mul(f4_set(v.z), f4_load(&rows[2][0])));
+    return f4_add(r, f4_mul(f4_set(v.w), f4_load(&rows[3][0])));
+}
+
+// dot product accumulated in the same order as multiply_rows
+static inline float dot_ordered(const glm::vec4& a, const glm::vec4& b) {
+    float r = a.x * b.x;
+    r += a.y * b.y;
+    r += a.z * b.z;
+    return r + a.w * b.w;
+}
+
+/**
+ * @brief      Skinning constructor
+ *
+ * @param      mesh  rigged mesh
+ */
+Skinning::Skinning(Mesh* mesh) {
+    this->nr_bones = mesh->get_armature() ? mesh->get_armature()->get_nr_bones() : 0;
+
+    std::vector<glm::vec3> p, n;
+    if(this->nr_bones == 0 || !mesh->decode_vertices(&p, &n, &this->bone_indices, &this->bone_weights)) {
+        this->bone_indices.clear();
+        this->bone_weights.clear();
+        return;
+    }
+
+    this->positions.resize(p.size());
+    this->normals.resize(n.size());
+    for(unsigned int i=0; i<p.size(); i++) {
+        this->positions[i] = glm::vec4(p[i], 1.0f);
+        this->normals[i] = glm::vec4(n[i], 0.0f);
+    }
+}
+
+/**
+ * @brief      skin all vertices
+ *
+ * @param[in]  palette        bone palette
+ * @param[out] out_positions  deformed positions
+ * @param[out] out_normals    deformed normals (may be NULL)
+ */
+void Skinning::apply(const glm::mat4* palette, glm::vec3* out_positions, glm::vec3* out_normals) const {
+    // with the rows of the bones, a vector times a bone takes four
+    // multiply-adds of whole registers instead of four dot products
+    std::vector<glm::mat4> rows(this->nr_bones);
+    for(unsigned int i=0; i<this->nr_bones; i++) {
+        rows[i] = glm::transpose(palette[i]);
+    }
+
+    JobSystem::get().parallel_for(this->positions.size(), BATCH_SIZE, [this, &rows, out_positions, out_normals](unsigned int begin, unsigned int end) {
+        this->apply_range(&rows[0], begin, end, out_positions, out_normals);
+    });
+}
+
+/**
+ * @brief      skin all vertices on the calling thread without SIMD
+ *
+ * @param[in]  palette        bone palette
+ * @param[out] out_positions  deformed positions
+ * @param[out] out_normals    deformed normals (may be NULL)
+ */
+void Skinning::apply_reference(const glm::mat4* palette, glm::vec3* out_positions, glm::vec3* out_normals) const {
+    for(unsigned int j=0; j<this->positions.size(); j++) {
+        glm::vec4 pos(0.0f, 0.0f, 0.0f, 1.0f);
+        glm::vec4 nor(0.0f, 0.0f, 0.0f, 1.0f);
+
+        for(unsigned int i=0; i<Mesh::MAX_BONE_INFLUENCES; i++) {
+            const glm::mat4& bone = palette[this->bone_indices[j][i]];
+            const glm::vec4 p = this->bone_weights[j][i] * this->positions[j];
+            const glm::vec4 n = this->bone_weights[j][i] * this->normals[j];
+            pos += glm::vec4(dot_ordered(p, bone[0]), dot_ordered(p, bone[1]), dot_ordered(p, bone[2]), dot_ordered(p, bone[3]));
+            nor += glm::vec4(dot_ordered(n, bone[0]), dot_ordered(n, bone[1]), dot_ordered(n, bone[2]), dot_ordered(n, bone[3]));
+        }
+
+        out_positions[j] = glm::vec3(pos);
+        if(out_normals) {
+            out_normals[j] = glm::vec3(nor);
+        }
+    }
+}
+
+/**
+ * @brief      skin a range of vertices
+ *
+ * @param[in]  rows           transposed bone palette
+ * @param[in]  begin          first vertex
+ * @param[in]  end            one past the last vertex
+ * @param[out] out_positions  deformed positions
+ * @param[out] out_normals    deformed normals (may be NULL)
+ */
+void Skinning::apply_range(const glm::mat4* rows, unsigned int begin, unsigned int end,
+                           glm::vec3* out_positions, glm::vec3* out_normals) const {
+    static const float origin[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    float result[4];
+
+    for(unsigned int j=begin; j<end; j++) {
+        float4 pos = f4_load(origin);
+        float4 nor = f4_load(origin);
+
+        for(unsigned int i=0; i<Mesh::MAX_BONE_INFLUENCES; i++) {
+            const glm::mat4& bone = rows[this->bone_indices[j][i]];
+            const float w = this->bone_weights[j][i];
+            pos = f4_add(pos, multiply_rows(w * this->positions[j], bone));
+            if(out_normals) {
+                nor = f4_add(nor, multiply_rows(w * this->normals[j], bone));
+            }
+        }
+
+        f4_store(result, pos);
+        out_positions[j] = glm::vec3(result[0], result[1], result[2]);
+        if(out_normals) {
+            f4_store(result, nor);
+            out_normals[j] = glm::vec3(result[0], result[1], result[2]);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#ifndef _SKINNING_H
+#define _SKINNING_H
+
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "accessoires/simd.h"
+#include "core/mesh.h"
+#include "core/job_system.h"
+
+/**
+ * @brief      applies a bone palette to the vertices of a rigged mesh on
+ *             the CPU
+ *
+ * Reproduces the skinning of the vertex shaders (turbine.vs), such that
+ * deformed positions are available for picking, bounds of a pose and runs
+ * without a GPU. The vertices are decoded from their GPU formats once (see
+ * Mesh::decode_vertices) and every product is formed in the order of the
+ * shader: each bone transforms the weighted vertex, (w * v) * bone, as a
+ * row vector. The GPU may still differ in the last bit where it fuses
+ * multiplications and additions.
+ *
+ * Vertices are processed in parallel batches on the JobSystem, with the
+ * four components of a vertex in a single SSE register.
+ */
+class Skinning {
+private:
+    std::vector<glm::vec4> positions;       //!< positions as received by the shader (w = 1)
+    std::vector<glm::vec4> normals;         //!< normals as received by the shader (w = 0)
+    std::vector<glm::uvec4> bone_indices;   //!< bones influencing every vertex
+    std::vector<glm::vec4> bone_weights;    //!< weights of these bones
+    unsigned int nr_bones;                  //!< number of bones in the palette
+
+public:
+    /**
+     * @brief      Skinning constructor
+     *
+     *             Requires the positions, normals and bone weights of the
+     *             mesh on the CPU (see Mesh::RETAIN_*); otherwise there are
+     *             no vertices to skin.
+     *
+     * @param      mesh  rigged mesh
+     */
+    Skinning(Mesh* mesh);
+
+    /**
+     * @brief      skin all vertices
+     *
+     * @param[in]  palette        bone palette (e.g. Pose::get_palette)
+     * @param[out] out_positions  get_nr_vertices() deformed positions
+     * @param[out] out_normals    get_nr_vertices() deformed normals (may be NULL)
+     */
+    void apply(const glm::mat4* palette, glm::vec3* out_positions, glm::vec3* out_normals) const;
+
+    /**
+     * @brief      skin all vertices on the calling thread without SIMD, as
+     *             a literal transcription of the shader
+     *
+     * @param[in]  palette        bone palette
+     * @param[out] out_positions  get_nr_vertices() deformed positions
+     * @param[out] out_normals    get_nr_vertices() deformed normals (may be NULL)
+     */
+    void apply_reference(const glm::mat4* palette, glm::vec3* out_positions, glm::vec3* out_normals) const;
+
+    /**
+     * @brief      get the number of vertices
+     *
+     * @return     number of vertices
+     */
+    inline unsigned int get_nr_vertices() const {
+        return this->positions.size();
+    }
+
+    static const unsigned int BATCH_SIZE = 1024;    //!< number of vertices per job
+
+private:
+    /**
+     * @brief      skin a range of vertices
+     *
+     * @param[in]  rows           transposed bone palette
+     * @param[in]  begin          first vertex
+     * @param[in]  end            one past the last vertex
+     * @param[out] out_positions  deformed positions
+     * @param[out] out_normals    deformed normals (may be NULL)
+     */
+    void apply_range(const glm::mat4* rows, unsigned int begin, unsigned int end,
+                     glm::vec3* out_positions, glm::vec3* out_normals) const;
+};
+
+#endif // _SKINNING_H
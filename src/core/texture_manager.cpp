@@ -20,6 +20,18 @@
 
 #include "texture_manager.h"
 
+/**
+ * @brief      header of a GPU-ready .itex file
+ */
+struct TextureFileHeader {
+    char magic[4];                  //!< "ITEX"
+    uint32_t version;               //!< Texture::RAW_FILE_VERSION
+    uint32_t width;                 //!< width of the image
+    uint32_t height;                //!< height of the image
+    int32_t format;                 //!< GL pixel format
+    uint32_t size;                  //!< number of bytes of pixel data
+};
+
 TextureManager::TextureManager() {
     Console::get() << std::string(__FILE__) << ": Starting TextureManager class" << Console::endl;
 }
@@ -29,65 +41,188 @@ unsigned int TextureManager::load_texture(const std::string& filename) {
     return this->textures.size() - 1;
 }
 
+unsigned int TextureManager::load_texture_async(const std::string& filename, const std::string& fallback) {
+    Texture* texture = new Texture();
+    this->textures.push_back(texture);
+
+    AssetLoader::get().submit([texture, filename, fallback]() {
+                                  if(!texture->decode(filename) && !fallback.empty()) {
+                                      texture->decode(fallback);
+                                  }
+                              },
+                              std::bind(&Texture::upload, texture));
+
+    return this->textures.size() - 1;
+}
+
+void TextureManager::unload_texture(unsigned int texture_id) {
+    delete this->textures[texture_id];
+    this->textures[texture_id] = NULL;
+}
+
 void TextureManager::bind_texture(unsigned int texture_id) {
     this->textures[texture_id]->bind();
 }
 
 void TextureManager::unbind() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(0, GL_TEXTURE_2D, 0);
+}
+
+Texture::Texture() {
+    this->m_texture = 0;
+    this->width = 0;
+    this->height = 0;
+    this->format = GL_RGBA;
+    this->flag_loaded = false;
+    this->flag_failed = false;
+    this->load_record = LoadStatistics::NO_RECORD;
 }
 
 Texture::Texture(const std::string& filename) {
-    unsigned int width, height;
+    this->m_texture = 0;
+    this->width = 0;
+    this->height = 0;
+    this->format = GL_RGBA;
+    this->flag_loaded = false;
+    this->flag_failed = false;
+    this->load_record = LoadStatistics::NO_RECORD;
+
+    this->decode(filename);
+    this->upload();
+}
+
+bool Texture::decode(const std::string& filename) {
+    this->filename = filename;
+    this->load_record = LoadStatistics::get().add_record("texture", filename);
 
+    // runs on worker threads, so failures are reported rather than ending the program
     std::size_t pos = filename.find_last_of(".");
-    std::string ext = filename.substr(pos);
+    std::string ext = (pos == std::string::npos) ? "" : filename.substr(pos);
 
     if(ext == ".PNG" || ext == ".png") {
-        m_texture = png_texture_load(filename.c_str(), &width, &height);
-        Console::get() << std::string(__FILE__) << ": Loading texture " << filename << Console::endl;
-        return;
+        // libpng reads while decoding
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_PARSE);
+        return this->png_texture_decode(filename.c_str());
+    }
+
+    if(ext == ".itex") {
+        LoadTimer timer(this->load_record, LoadStatistics::PHASE_READ);
+        return this->raw_texture_decode(filename.c_str());
     }
 
     std::cerr << "Cannot handle texture file: " << filename << std::endl;
     std::cerr << "Unknown extension: " << ext << std::endl;
-    exit(-1);
+    return false;
+}
+
+void Texture::upload() {
+    if(this->image_data.empty()) {
+        Console::get() << std::string(__FILE__) << ": Failed to load texture " << this->filename << Console::endl;
+        this->flag_failed = true;
+        return;
+    }
+
+    Console::get() << std::string(__FILE__) << ": Loading texture " << this->filename << Console::endl;
+
+    LoadTimer timer(this->load_record, LoadStatistics::PHASE_UPLOAD);
+
+    // Generate the OpenGL texture object
+    glGenTextures(1, &this->m_texture);
+    GLState::get().bind_texture(0, GL_TEXTURE_2D, this->m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, this->format, this->width, this->height, 0, this->format, GL_UNSIGNED_BYTE, &this->image_data[0]);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // the pixels now live on the GPU
+    std::vector<png_byte>().swap(this->image_data);
+    this->flag_loaded = true;
+
+    LoadStatistics::get().set_memory(this->load_record, 0, this->get_memory());
+}
+
+bool Texture::save_raw_file(const std::string& filename) const {
+    std::ofstream f(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if(!f.is_open() || this->image_data.empty()) {
+        std::cerr << "Unable to write texture file: " << filename << std::endl;
+        return false;
+    }
+
+    TextureFileHeader header;
+    std::memcpy(header.magic, "ITEX", 4);
+    header.version = RAW_FILE_VERSION;
+    header.width = this->width;
+    header.height = this->height;
+    header.format = this->format;
+    header.size = this->image_data.size();
+
+    f.write((const char*)&header, sizeof(TextureFileHeader));
+    f.write((const char*)&this->image_data[0], this->image_data.size());
+
+    return f.good();
+}
+
+bool Texture::is_raw_file_current(const std::string& filename) {
+    std::ifstream f(filename.c_str(), std::ios::binary);
+
+    TextureFileHeader header;
+    if(!f.read((char*)&header, sizeof(TextureFileHeader))) {
+        return false;
+    }
+
+    return std::memcmp(header.magic, "ITEX", 4) == 0 && header.version == RAW_FILE_VERSION;
+}
+
+size_t Texture::get_memory() const {
+    size_t bytes = this->image_data.size();
+
+    if(this->m_texture != 0) {
+        bytes += this->width * this->height * (this->format == GL_RGB ? 3 : 4);
+    }
+
+    return bytes;
 }
 
 Texture::~Texture() {
-    glDeleteTextures(1, &m_texture);
+    // textures that were only decoded (e.g. by the asset compiler) have no GL object
+    if(this->m_texture != 0) {
+        GLState::get().forget_texture(this->m_texture);
+        glDeleteTextures(1, &m_texture);
+    }
 }
 
 void Texture::bind() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_texture);
+    GLState::get().bind_texture(0, GL_TEXTURE_2D, m_texture);
 }
 
-GLuint Texture::png_texture_load(const char * file_name, unsigned int * width, unsigned int * height) {
+bool Texture::png_texture_decode(const char * file_name) {
 
     png_byte header[8];
 
     FILE *fp = fopen(file_name, "rb");
     if (fp == 0) {
         perror(file_name);
-        return 0;
+        return false;
     }
 
     // read the header
     fread(header, 1, 8, fp);
 
+    struct stat st;
+    if(fstat(fileno(fp), &st) == 0) {
+        LoadStatistics::get().add_bytes_read(this->load_record, st.st_size);
+    }
+
     if (png_sig_cmp(header, 0, 8)) {
         fprintf(stderr, "error: %s is not a PNG.\n", file_name);
         fclose(fp);
-        return 0;
+        return false;
     }
 
     png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (!png_ptr) {
         fprintf(stderr, "error: png_create_read_struct returned 0.\n");
         fclose(fp);
-        return 0;
+        return false;
     }
 
     // create png info struct
@@ -96,7 +231,7 @@ GLuint Texture::png_texture_load(const char * file_name, unsigned int * width, u
         fprintf(stderr, "error: png_create_info_struct returned 0.\n");
         png_destroy_read_struct(&png_ptr, (png_infopp)NULL, (png_infopp)NULL);
         fclose(fp);
-        return 0;
+        return false;
     }
 
     // create png info struct
@@ -105,15 +240,16 @@ GLuint Texture::png_texture_load(const char * file_name, unsigned int * width, u
         fprintf(stderr, "error: png_create_info_struct returned 0.\n");
         png_destroy_read_struct(&png_ptr, &info_ptr, (png_infopp) NULL);
         fclose(fp);
-        return 0;
+        return false;
     }
 
     // the code in this if statement gets called if libpng encounters an error
     if (setjmp(png_jmpbuf(png_ptr))) {
         fprintf(stderr, "error from libpng\n");
         png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
+        std::vector<png_byte>().swap(this->image_data);
         fclose(fp);
-        return 0;
+        return false;
     }
 
     // init png reading
@@ -133,32 +269,35 @@ GLuint Texture::png_texture_load(const char * file_name, unsigned int * width, u
     png_get_IHDR(png_ptr, info_ptr, &temp_width, &temp_height, &bit_depth, &color_type,
         NULL, NULL, NULL);
 
-    if (width){ *width = temp_width; }
-    if (height){ *height = temp_height; }
+    this->width = temp_width;
+    this->height = temp_height;
 
     //printf("%s: %lux%lu %d\n", file_name, temp_width, temp_height, color_type);
 
     if (bit_depth != 8) {
         fprintf(stderr, "%s: Unsupported bit depth %d.  Must be 8.\n", file_name, bit_depth);
-        return 0;
+        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
+        fclose(fp);
+        return false;
     }
 
-    GLint format;
     switch(color_type)
     {
     case PNG_COLOR_TYPE_RGB:
-        format = GL_RGB;
+        this->format = GL_RGB;
         break;
     case PNG_COLOR_TYPE_RGB_ALPHA:
-        format = GL_RGBA;
+        this->format = GL_RGBA;
         break;
     case PNG_COLOR_TYPE_PALETTE:
-        format = GL_RGBA;
+        this->format = GL_RGBA;
         png_set_palette_to_rgb(png_ptr);
         break;
     default:
         fprintf(stderr, "%s: Unknown libpng color type %d.\n", file_name, color_type);
-        return 0;
+        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
+        fclose(fp);
+        return false;
     }
 
     // Update the png info struct.
@@ -171,44 +310,68 @@ GLuint Texture::png_texture_load(const char * file_name, unsigned int * width, u
     rowbytes += 3 - ((rowbytes-1) % 4);
 
     // Allocate the image_data as a big block, to be given to opengl
-    png_byte * image_data = (png_byte *)malloc(rowbytes * temp_height * sizeof(png_byte)+15);
-    if (image_data == NULL) {
-        fprintf(stderr, "error: could not allocate memory for PNG image data\n");
-        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-        fclose(fp);
-        return 0;
-    }
+    this->image_data.resize(rowbytes * temp_height * sizeof(png_byte)+15);
 
     // row_pointers is for pointing to image_data for reading the png with libpng
     png_byte ** row_pointers = (png_byte **)malloc(temp_height * sizeof(png_byte *));
     if (row_pointers == NULL) {
         fprintf(stderr, "error: could not allocate memory for PNG row pointers\n");
         png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-        free(image_data);
+        std::vector<png_byte>().swap(this->image_data);
         fclose(fp);
-        return 0;
+        return false;
     }
 
     // set the individual row_pointers to point at the correct offsets of image_data
     for (unsigned int i = 0; i < temp_height; i++) {
-        row_pointers[temp_height - 1 - i] = image_data + i * rowbytes;
+        row_pointers[temp_height - 1 - i] = &this->image_data[0] + i * rowbytes;
     }
 
     // read the png into image_data through row_pointers
     png_read_image(png_ptr, row_pointers);
 
-    // Generate the OpenGL texture object
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, temp_width, temp_height, 0, format, GL_UNSIGNED_BYTE, image_data);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
     // clean up
     png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-    free(image_data);
     free(row_pointers);
     fclose(fp);
-    return texture;
+    return true;
+}
+
+bool Texture::raw_texture_decode(const char * file_name) {
+    const int fd = open(file_name, O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TextureFileHeader)) {
+        perror(file_name);
+        if(fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        perror(file_name);
+        return false;
+    }
+
+    TextureFileHeader header;
+    std::memcpy(&header, data, sizeof(TextureFileHeader));
+
+    if(std::memcmp(header.magic, "ITEX", 4) != 0 || header.version != RAW_FILE_VERSION || st.st_size < (off_t)(sizeof(TextureFileHeader) + header.size)) {
+        fprintf(stderr, "error: %s is not a texture file.\n", file_name);
+        munmap(data, st.st_size);
+        return false;
+    }
+
+    // the pixels are already laid out for glTexImage2D
+    this->width = header.width;
+    this->height = header.height;
+    this->format = header.format;
+    const png_byte* pixels = (const png_byte*)data + sizeof(TextureFileHeader);
+    this->image_data.assign(pixels, pixels + header.size);
+
+    munmap(data, st.st_size);
+    LoadStatistics::get().add_bytes_read(this->load_record, st.st_size);
+    return true;
 }
@@ -26,7 +26,12 @@
 #include <iostream>
 #include <fstream>
 #include <cassert>
+#include <cstring>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // opengl libs
 #include <GL/glew.h>
@@ -39,6 +44,9 @@
 // image libs
 #include <png.h>
 
+#include "core/asset_loader.h"
+#include "core/load_statistics.h"
+#include "core/gl_state.h"
 #include "ui/console.h"
 
 /*
@@ -48,18 +56,85 @@
  */
 class Texture {
 public:
+    Texture();
+
     Texture(const std::string& filename);
 
+    /**
+     * @brief      decode the image file into memory (does not require a GL context)
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true on success
+     */
+    bool decode(const std::string& filename);
+
+    /**
+     * @brief      create the GL texture from the decoded image
+     *
+     *             Textures without decoded image data are marked as failed
+     *             and never become loaded.
+     */
+    void upload();
+
+    /**
+     * @brief      write the decoded image as a GPU-ready .itex file
+     *
+     *             The pixels are stored exactly as glTexImage2D expects them
+     *             (see AssetCompiler).
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true on success
+     */
+    bool save_raw_file(const std::string& filename) const;
+
+    /**
+     * @brief      check whether a .itex file has the current format
+     *
+     * @param[in]  filename  The filename
+     *
+     * @return     true if the file exists and matches RAW_FILE_VERSION
+     */
+    static bool is_raw_file_current(const std::string& filename);
+
+    static const uint32_t RAW_FILE_VERSION = 2;     //!< version of the .itex format (version 1 had no version field)
+
     void bind();
 
+    inline bool is_loaded() const {
+        return this->flag_loaded;
+    }
+
+    inline bool is_failed() const {
+        return this->flag_failed;
+    }
+
+    /**
+     * @brief      get the memory occupied by the texture
+     *
+     * @return     size in bytes (GPU copy and any pending decoded data)
+     */
+    size_t get_memory() const;
+
     virtual ~Texture();
 protected:
 private:
     Texture(const Texture& other) {}
     void operator=(const Texture& other) {}
-    GLuint png_texture_load(const char * file_name, unsigned int * width, unsigned int * height);
+    bool png_texture_decode(const char * file_name);
+    bool raw_texture_decode(const char * file_name);
 
     GLuint m_texture;
+
+    std::string filename;                   //!< filename of the image
+    std::vector<png_byte> image_data;       //!< decoded image data (released after upload)
+    unsigned int width;                     //!< width of the image
+    unsigned int height;                    //!< height of the image
+    GLint format;                           //!< pixel format of the image
+    bool flag_loaded;                       //!< whether the texture resides on the GPU
+    bool flag_failed;                       //!< whether the image could not be decoded
+    unsigned int load_record;               //!< record in LoadStatistics
 };
 
 class TextureManager {
@@ -71,6 +146,38 @@ public:
 
     unsigned int load_texture(const std::string& filename);
 
+    /**
+     * @brief      load a texture using the AssetLoader
+     *
+     *             The texture binds as empty until it has been uploaded.
+     *
+     * @param[in]  filename  The filename
+     * @param[in]  fallback  file decoded instead if filename cannot be decoded
+     *                       (e.g. the source of a compiled texture)
+     *
+     * @return     texture id
+     */
+    unsigned int load_texture_async(const std::string& filename, const std::string& fallback = "");
+
+    inline bool is_loaded(unsigned int texture_id) const {
+        return this->textures[texture_id]->is_loaded();
+    }
+
+    inline bool is_failed(unsigned int texture_id) const {
+        return this->textures[texture_id]->is_failed();
+    }
+
+    inline size_t get_memory(unsigned int texture_id) const {
+        return this->textures[texture_id]->get_memory();
+    }
+
+    /**
+     * @brief      free a texture; its id is not reused
+     *
+     * @param[in]  texture_id  texture id
+     */
+    void unload_texture(unsigned int texture_id);
+
     void bind_texture(unsigned int texture_id);
 
     void unbind();
@@ -96,6 +96,14 @@ void Visualizer::run() {
         // stop drawing here
         Display::get().close_frame();  /* close the frame */
     }
+
+    // release the assets while the GL context is still alive
+    ObjectsEngine::get().clear();
+
+    // keep a machine-readable record of where loading time and memory went
+    if(!LoadStatistics::get().write(LoadStatistics::REPORT_FILE)) {
+        std::cerr << "Unable to write " << LoadStatistics::REPORT_FILE << std::endl;
+    }
 }
 
 /**this->visualizer_state &= ~STATE_CONSOLE;
@@ -239,23 +247,27 @@ void Visualizer::update(double dt) {
 }
 
 void Visualizer::pre_draw() {
+    GLState::get().new_frame();
+    Shader::new_frame();
     Display::get().open_frame();   /* start new frame */
     PostProcessor::get().bind_frame_buffer();
     const glm::vec4& color = Sky::get().get_sky_color();
     glClearColor(color[0], color[1], color[2], color[3]);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
+    GLState::get().enable(GL_DEPTH_TEST);
     Camera::get().update();
+    FrameConstants::get().update(this->frame_start);
 }
 
 void Visualizer::draw() {
     Terrain::get().draw();
     ObjectsEngine::get().draw();
+    RenderQueue::get().execute();
 }
 
 void Visualizer::post_draw() {
     PostProcessor::get().unbind_frame_buffer();
-    glDisable(GL_DEPTH_TEST);
+    GLState::get().disable(GL_DEPTH_TEST);
     PostProcessor::get().draw();
 
     if(this->state & STATE_CONSOLE) {
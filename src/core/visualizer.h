@@ -31,6 +31,9 @@
 #include "objects/objects_engine.h"
 #include "core/font_writer.h"
 #include "core/post_processor.h"
+#include "core/load_statistics.h"
+#include "core/frame_constants.h"
+#include "core/render_queue.h"
 #include "environment/sky.h"
 #include "ui/console.h"
 
@@ -82,7 +82,16 @@ Terrain::Terrain() {
 
     Shader* shader = new Shader("assets/shaders/terrain");
     Mesh* mesh = new Mesh();
-    this->generate_terrain(mesh);
+
+    // the mesh reports its upload and footprint to the terrain record
+    const unsigned int load_record = LoadStatistics::get().add_record("terrain", "(generated)");
+    {
+        LoadTimer timer(load_record, LoadStatistics::PHASE_PROCESS);
+        this->generate_terrain(mesh);
+        mesh->build_meshlets();
+    }
+    mesh->set_load_record(load_record);
+    mesh->set_vertex_compression(Mesh::COMPRESS_ALL);
     mesh->static_load();
 
     this->ter = new Object(shader, mesh);
@@ -97,7 +106,7 @@ Terrain::Terrain() {
  * @return      reference to the terrain object (singleton pattern)
  */
 void Terrain::draw() {
-    this->ter->draw();
+    this->ter->submit();
 }
 
 /**
@@ -0,0 +1,61 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include "core/asset_compiler.h"
+
+/*
+ * isana-assetc [-f] [-j threads] [asset directory]
+ *
+ * Converts the asset tree into its compiled form (see AssetCompiler). Only
+ * assets whose contents changed since the previous run are rebuilt, unless
+ * -f is given.
+ */
+int main(int argc, char* argv[]) {
+    std::string root = AssetCompiler::ASSET_ROOT;
+    unsigned int nr_threads = std::max(1u, std::thread::hardware_concurrency());
+    bool force = false;
+
+    for(int i=1; i<argc; i++) {
+        const std::string arg(argv[i]);
+        if(arg == "-f") {
+            force = true;
+        } else if(arg == "-j" && i+1 < argc) {
+            nr_threads = std::max(1, atoi(argv[++i]));
+        } else if(arg[0] == '-') {
+            std::cerr << "Usage: " << argv[0] << " [-f] [-j threads] [asset directory]" << std::endl;
+            return -1;
+        } else {
+            root = arg;
+        }
+    }
+
+    AssetCompiler compiler(root);
+    const unsigned int nr_jobs = compiler.scan(force);
+    std::cout << nr_jobs << " assets out of date in " << root << std::endl;
+
+    const unsigned int nr_failed = compiler.compile(nr_threads);
+    if(nr_failed > 0) {
+        std::cerr << nr_failed << " assets failed to compile" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
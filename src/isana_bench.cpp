@@ -0,0 +1,126 @@
+/**************************************************************************
+#                                                                         #
+#   This file is part of ISANA                                            #
+#                                                                         #
+#   This program is free software; you can redistribute it and/or modify  #
+#   it under the terms of the GNU General Public License as published by  #
+#   the Free Software Foundation, version 3                               #
+#                                                                         #
+#   This program is distributed in the hope that it will be useful, but   #
+#   WITHOUT ANY WARRANTY; without even the implied warranty of            #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     #
+#   General Public License for more details.                              #
+#                                                                         #
+#   You should have received a copy of the GNU General Public License     #
+#   along with this program; if not, write to the Free Software           #
+#   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA             #
+#   02110-1301, USA.                                                      #
+#                                                                         #
+#**************************************************************************/
+
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <boost/chrono.hpp>
+
+#include "core/mesh.h"
+#include "core/pose.h"
+#include "core/skinning.h"
+
+// run a function repeatedly for at least a given time
+template<typename F>
+static double vertices_per_second(unsigned int nr_vertices, double duration, F func) {
+    const boost::chrono::high_resolution_clock::time_point start = boost::chrono::high_resolution_clock::now();
+    unsigned int nr_runs = 0;
+    double elapsed = 0.0;
+
+    do {
+        func();
+        nr_runs++;
+        elapsed = boost::chrono::duration<double>(boost::chrono::high_resolution_clock::now() - start).count();
+    } while(elapsed < duration);
+
+    return (double)nr_runs * nr_vertices / elapsed;
+}
+
+/*
+ * isana-bench [-t seconds] [mesh]
+ *
+ * Measures the throughput of CPU skinning (see Skinning) on a rigged mesh,
+ * without a window or GPU, and verifies that the vectorized routine gives
+ * the same results as the literal transcription of the shader.
+ */
+int main(int argc, char* argv[]) {
+    std::string filename = "assets/meshes/turbine.x";
+    double duration = 1.0;
+
+    for(int i=1; i<argc; i++) {
+        const std::string arg(argv[i]);
+        if(arg == "-t" && i+1 < argc) {
+            duration = std::max(0.01, atof(argv[++i]));
+        } else if(arg[0] == '-') {
+            std::cerr << "Usage: " << argv[0] << " [-t seconds] [mesh]" << std::endl;
+            return -1;
+        } else {
+            filename = arg;
+        }
+    }
+
+    // decode the vertices in the formats the game uploads
+    Mesh mesh(filename);
+    mesh.set_vertex_compression(Mesh::COMPRESS_ALL);
+
+    if(mesh.get_armature() == NULL) {
+        std::cerr << filename << " has no armature" << std::endl;
+        return -1;
+    }
+
+    Skinning skinning(&mesh);
+    const unsigned int nr_vertices = skinning.get_nr_vertices();
+    if(nr_vertices == 0) {
+        std::cerr << filename << " has no skinned vertices" << std::endl;
+        return -1;
+    }
+
+    // bend every bone, such that all of them contribute
+    Pose pose(mesh.get_armature());
+    for(unsigned int i=0; i<pose.get_nr_bones(); i++) {
+        pose.set_bone_transformation(i, glm::rotate(glm::mat4(1.0f), 0.25f * (float)(i + 1), glm::vec3(0.6f, 0.0f, 0.8f)));
+    }
+    pose.evaluate();
+    const glm::mat4* palette = pose.get_palette();
+
+    std::vector<glm::vec3> ref_positions(nr_vertices), ref_normals(nr_vertices);
+    std::vector<glm::vec3> positions(nr_vertices), normals(nr_vertices);
+    skinning.apply_reference(palette, &ref_positions[0], &ref_normals[0]);
+    skinning.apply(palette, &positions[0], &normals[0]);
+
+    unsigned int nr_mismatches = 0;
+    for(unsigned int i=0; i<nr_vertices; i++) {
+        if(std::memcmp(&ref_positions[i][0], &positions[i][0], sizeof(glm::vec3)) != 0 ||
+           std::memcmp(&ref_normals[i][0], &normals[i][0], sizeof(glm::vec3)) != 0) {
+            nr_mismatches++;
+        }
+    }
+
+    std::cout << filename << ": " << nr_vertices << " vertices, " << pose.get_nr_bones() << " bones, "
+              << JobSystem::get().get_nr_threads() << " threads" << std::endl;
+
+    const double reference = vertices_per_second(nr_vertices, duration, [&]() {
+        skinning.apply_reference(palette, &ref_positions[0], &ref_normals[0]);
+    });
+    const double full = vertices_per_second(nr_vertices, duration, [&]() {
+        skinning.apply(palette, &positions[0], &normals[0]);
+    });
+    const double positions_only = vertices_per_second(nr_vertices, duration, [&]() {
+        skinning.apply(palette, &positions[0], NULL);
+    });
+
+    std::cout << "reference (scalar, 1 thread):  " << reference * 1e-6 << " Mvertices/s" << std::endl;
+    std::cout << "vectorized, normals:            " << full * 1e-6 << " Mvertices/s" << std::endl;
+    std::cout << "vectorized, positions only:     " << positions_only * 1e-6 << " Mvertices/s" << std::endl;
+    std::cout << nr_mismatches << " vertices differ from the reference" << std::endl;
+
+    return nr_mismatches == 0 ? 0 : -1;
+}
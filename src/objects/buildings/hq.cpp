@@ -21,17 +21,10 @@
 #include "hq.h"
 
 void BuildingHeadQuarters::update(double dt) {
-    angle += dt;
-
-    if(angle > 2.0 * M_PI) {
-        angle -= 2.0 * M_PI;
+    // the clip is part of the mesh and only available once it is loaded
+    if(this->animation.get_clip() == NULL) {
+        this->animation.play(this->mesh->find_animation_clip("Scan"));
     }
 
-    glm::mat4 rot_mat = glm::rotate(glm::mat4(1.0), (float)this->angle, glm::vec3(0,0,1));
-    glm::mat4 rot_mat2 = glm::rotate(glm::mat4(1.0), (float)this->angle * 5.0f, glm::vec3(0,0,1));
-
-    this->mesh->get_armature()->set_bone_transformation(1, rot_mat);
-    this->mesh->get_armature()->set_bone_transformation(2, rot_mat2);
-    this->mesh->get_armature()->build_glsl_matrices();
-    this->properties[this->rig_idx].set_value(&this->mesh->get_armature()->get_glsl_matrices()[0][0][0]);
+    Object::update(dt);
 }
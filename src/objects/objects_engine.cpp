@@ -23,15 +23,21 @@
 ObjectsEngine::ObjectsEngine() {
     Console::get() << std::string(__FILE__) << ": Starting ObjectEngine class" << Console::endl;
 
-    const unsigned int hq_tex_id = TextureManager::get().load_texture("assets/png/hq.png");
+    this->nr_animated[Object::ANIMATION_NONE] = 0;
+    this->nr_animated[Object::ANIMATION_PARTIAL] = 0;
+    this->nr_animated[Object::ANIMATION_FULL] = 0;
+    this->nr_instances = 0;
+    this->nr_draw_calls = 0;
+
+    // assets are parsed on worker threads and uploaded while the first frames are drawn
+    this->add_texture("assets/png/hq.png");
     this->add_shader("assets/shaders/turbine");
     this->add_mesh("assets/meshes/hq.x");
 
-    this->objects.push_back(new BuildingHeadQuarters(this->shaders.back(), this->meshes.back(), hq_tex_id));
+    this->objects.push_back(new BuildingHeadQuarters(this->shaders.back(), this->meshes.back(), this->textures.back()));
     this->objects.back()->set_position(glm::vec3(40, 50, Terrain::get().get_height(40,50)));
-    this->objects.back()->load();
 
-    const unsigned int turbine_tex_id = TextureManager::get().load_texture("assets/png/turbine.png");
+    this->add_texture("assets/png/turbine.png");
     this->add_shader("assets/shaders/turbine");
     this->add_mesh("assets/meshes/turbine.x");
 
@@ -45,37 +51,131 @@ ObjectsEngine::ObjectsEngine() {
 
             float z = Terrain::get().get_height(x,y);
 
-            this->objects.push_back(new BuildingTurbine(this->shaders.back(), this->meshes.back(), turbine_tex_id));
+            this->objects.push_back(new BuildingTurbine(this->shaders.back(), this->meshes.back(), this->textures.back()));
             this->objects.back()->set_position(glm::vec3(x, y, z));
-            this->objects.back()->load();
        }
     }
 }
 
 void ObjectsEngine::update(double dt) {
+    this->nr_animated[Object::ANIMATION_NONE] = 0;
+    this->nr_animated[Object::ANIMATION_PARTIAL] = 0;
+    this->nr_animated[Object::ANIMATION_FULL] = 0;
+
+    JobSystem::get().parallel_for(this->objects.size(), UPDATE_BATCH_SIZE, [this, dt](unsigned int begin, unsigned int end) {
+        for(unsigned int i=begin; i<end; i++) {
+            if(this->objects[i]->is_loaded()) {
+                this->objects[i]->update(dt);
+            }
+        }
+    });
+
     for(unsigned int i=0; i<this->objects.size(); i++) {
-        this->objects[i]->update(dt);
+        if(this->objects[i]->is_loaded()) {
+            this->nr_animated[this->objects[i]->get_animation_lod()]++;
+        }
     }
+
+    // objects only set their bone transformations; identical poses are evaluated once
+    PoseManager::get().update();
 }
 
 void ObjectsEngine::draw() {
+    // upload finished assets and activate the objects that use them
+    if(AssetLoader::get().get_nr_pending() > 0) {
+        AssetLoader::get().process_uploads();
+    }
+
+    for(unsigned int i=0; i<this->objects.size(); i++) {
+        if(!this->objects[i]->is_loaded() && this->objects[i]->assets_ready()) {
+            this->objects[i]->load();
+        }
+    }
+
+    // all bone palettes go to the GPU at once; objects index their own slice
+    PoseManager::get().upload_palettes();
+
+    const glm::mat4& projection = FrameConstants::get().get_projection();
+    const glm::mat4& view_projection = FrameConstants::get().get_view_projection();
+
+    for(unsigned int i=0; i<this->batches.size(); i++) {
+        this->batches[i]->clear();
+    }
+
+    // group the visible objects by mesh, shader and texture
+    this->nr_instances = 0;
     for(unsigned int i=0; i<this->objects.size(); i++) {
-        this->objects[i]->draw();
+        if(this->objects[i]->is_loaded() && this->objects[i]->is_visible(view_projection)) {
+            this->get_batch(this->objects[i])->add(this->objects[i], this->objects[i]->select_lod(projection));
+            this->nr_instances++;
+        }
+    }
+
+    // the batches are drawn with the rest of the frame (see RenderQueue)
+    const glm::vec3 camera = FrameConstants::get().get_camera_position();
+    this->nr_draw_calls = 0;
+    for(unsigned int i=0; i<this->batches.size(); i++) {
+        this->nr_draw_calls += this->batches[i]->submit(camera);
     }
 }
 
+InstanceBatch* ObjectsEngine::get_batch(const Object* object) {
+    for(unsigned int i=0; i<this->batches.size(); i++) {
+        if(this->batches[i]->matches(object)) {
+            return this->batches[i];
+        }
+    }
+
+    this->batches.push_back(new InstanceBatch(object->get_shader(), object->get_mesh(), object->get_texture_id()));
+    return this->batches.back();
+}
+
 unsigned int ObjectsEngine::add_shader(const std::string& filename) {
-    this->shaders.push_back(new Shader(filename));
+    // shaders are shared among all users of the same program
+    this->shaders.push_back(AssetManager::get().acquire_shader(filename));
 
     return this->shaders.size() - 1;
 }
 
 unsigned int ObjectsEngine::add_mesh(const std::string& filename) {
-    this->meshes.push_back(new Mesh(filename));
+    // meshes are parsed on a worker thread and uploaded on the render thread;
+    // objects only need the GPU copy, counts, bounds and levels of detail
+    this->meshes.push_back(AssetManager::get().acquire_mesh(filename, Mesh::COMPRESS_ALL, Mesh::RETAIN_NONE));
 
-    Console::get() << std::string(__FILE__) + ": Loading mesh: " << filename << Console::endl;
+    return this->meshes.size() - 1;
+}
 
-    this->meshes.back()->static_load();
+unsigned int ObjectsEngine::add_texture(const std::string& filename) {
+    // textures are decoded on a worker thread and uploaded on the render thread
+    this->textures.push_back(AssetManager::get().acquire_texture(filename));
 
-    return this->meshes.size() - 1;
+    return this->textures.size() - 1;
+}
+
+void ObjectsEngine::clear() {
+    for(unsigned int i=0; i<this->objects.size(); i++) {
+        delete this->objects[i];
+    }
+    this->objects.clear();
+
+    for(unsigned int i=0; i<this->batches.size(); i++) {
+        delete this->batches[i];
+    }
+    this->batches.clear();
+
+    // every add_* acquired one reference
+    for(unsigned int i=0; i<this->meshes.size(); i++) {
+        AssetManager::get().release_mesh(this->meshes[i]);
+    }
+    for(unsigned int i=0; i<this->shaders.size(); i++) {
+        AssetManager::get().release_shader(this->shaders[i]);
+    }
+    for(unsigned int i=0; i<this->textures.size(); i++) {
+        AssetManager::get().release_texture(this->textures[i]);
+    }
+    this->meshes.clear();
+    this->shaders.clear();
+    this->textures.clear();
+
+    AssetManager::get().collect();
 }
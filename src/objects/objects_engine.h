@@ -23,9 +23,14 @@
 
 #include <vector>
 
+#include "core/asset_loader.h"
+#include "core/asset_manager.h"
 #include "core/mesh.h"
 #include "core/shader.h"
 #include "core/object.h"
+#include "core/instance_batch.h"
+#include "core/frame_constants.h"
+#include "core/job_system.h"
 #include "core/texture_manager.h"
 #include "environment/terrain.h"
 #include "objects/buildings/hq.h"
@@ -42,8 +47,14 @@ class ObjectsEngine {
 private:
     std::vector<Mesh*> meshes;
     std::vector<Shader*> shaders;
+    std::vector<unsigned int> textures;     //!< texture ids acquired from the AssetManager
 
     std::vector<Object*> objects;
+    std::vector<InstanceBatch*> batches;    //!< objects sharing mesh, shader and texture
+
+    unsigned int nr_animated[3];    //!< number of objects per animation level of detail in the last update
+    unsigned int nr_instances;      //!< number of objects drawn in the last frame
+    unsigned int nr_draw_calls;     //!< number of draw calls in the last frame
 
 public:
 
@@ -59,15 +70,78 @@ public:
         return objects_engine_instance;
     }
 
+    /**
+     * @brief      update all objects
+     *
+     *             Objects are updated in parallel batches (see Object::update
+     *             for what an update may touch), after which the poses are
+     *             evaluated.
+     *
+     * @param[in]  dt    time step
+     */
     void update(double dt);
 
+    /**
+     * @brief      get the number of objects whose pose was updated in a given way
+     *
+     * @param[in]  lod   Object::ANIMATION_NONE, ANIMATION_PARTIAL or ANIMATION_FULL
+     *
+     * @return     number of objects in the last update
+     */
+    inline unsigned int get_nr_animated(unsigned int lod) const {
+        return this->nr_animated[lod];
+    }
+
+    /**
+     * @brief      queue all visible objects, instanced per mesh, shader and
+     *             texture (see RenderQueue)
+     */
     void draw();
 
+    /**
+     * @brief      get the number of objects drawn in the last frame
+     *
+     * @return     number of instances
+     */
+    inline unsigned int get_nr_instances() const {
+        return this->nr_instances;
+    }
+
+    /**
+     * @brief      get the number of draw calls of the objects in the last frame
+     *
+     * @return     number of draw calls
+     */
+    inline unsigned int get_nr_draw_calls() const {
+        return this->nr_draw_calls;
+    }
+
     unsigned int add_shader(const std::string& filename);
 
     unsigned int add_mesh(const std::string& filename);
 
+    unsigned int add_texture(const std::string& filename);
+
+    /**
+     * @brief      delete all objects and release their assets
+     *
+     *             Needs to be called while the GL context is still alive;
+     *             assets without other users are freed right away.
+     */
+    void clear();
+
+    static const unsigned int UPDATE_BATCH_SIZE = 128;  //!< number of objects per job
+
 private:
+    /**
+     * @brief      get the batch an object is drawn in, creating it if needed
+     *
+     * @param[in]  object  the object
+     *
+     * @return     pointer to the batch
+     */
+    InstanceBatch* get_batch(const Object* object);
+
     /**
      * @brief       objects_engine constructor
      *
@@ -19,6 +19,11 @@
 #**************************************************************************/
 
 #include "console.h"
+#include "core/asset_manager.h"
+#include "core/load_statistics.h"
+#include "core/pose.h"
+#include "core/render_queue.h"
+#include "objects/objects_engine.h"
 
 // used to terminate Console input
 const char Console::endl = '\n';
@@ -57,6 +62,34 @@ void Console::draw() {
     this->add_line_left("Camera pos " + glm::to_string(Camera::get().get_position()));
     this->add_line_left("Camera distance " + boost::lexical_cast<std::string>(Camera::get().get_distance()));
 
+    const std::vector<std::string> assets = AssetManager::get().report();
+    for(unsigned int i=0; i<assets.size(); i++) {
+        this->add_line_left(assets[i]);
+    }
+
+    this->add_line_left((boost::format("Poses: %u evaluated, %u shared") % PoseManager::get().get_nr_evaluated()
+                         % PoseManager::get().get_nr_shared()).str());
+    this->add_line_left((boost::format("Skeletons: %u full, %u partial, %u frozen")
+                         % ObjectsEngine::get().get_nr_animated(Object::ANIMATION_FULL)
+                         % ObjectsEngine::get().get_nr_animated(Object::ANIMATION_PARTIAL)
+                         % ObjectsEngine::get().get_nr_animated(Object::ANIMATION_NONE)).str());
+    this->add_line_left((boost::format("Objects: %u instances in %u draw calls") % ObjectsEngine::get().get_nr_instances()
+                         % ObjectsEngine::get().get_nr_draw_calls()).str());
+    this->add_line_left((boost::format("Render queue: %u packets, %u program, %u texture and %u VAO switches")
+                         % RenderQueue::get().get_nr_packets() % RenderQueue::get().get_nr_program_switches()
+                         % RenderQueue::get().get_nr_texture_switches() % RenderQueue::get().get_nr_vao_switches()).str());
+    this->add_line_left((boost::format("GL state: %u calls, %u redundant calls skipped") % GLState::get().get_nr_calls()
+                         % GLState::get().get_nr_avoided()).str());
+    this->add_line_left((boost::format("Uniforms: %u bytes uploaded, %u bytes unchanged") % Shader::get_uniform_bytes_uploaded()
+                         % Shader::get_uniform_bytes_skipped()).str());
+    this->add_line_left((boost::format("Palette buffer: %u palettes, %u bones") % PaletteBuffer::get().get_nr_palettes()
+                         % PaletteBuffer::get().get_nr_bones()).str());
+
+    const std::vector<std::string> loads = LoadStatistics::get().report();
+    for(unsigned int i=0; i<loads.size(); i++) {
+        this->add_line_left(loads[i]);
+    }
+
     for(unsigned int i=0; i<this->log.size(); i++) {
         this->add_line_right("[" + (boost::format("%10.5f") % log_times[i]).str() + "] " + log[i]);
     }